@@ -4,12 +4,94 @@
  *
  * File Name: buzzer.c
  *
- * Description: Source file for the Buzzer driver
+ * Description: Source file for Buzzer driver
  *
  * Author: Mahmoud Khalafallah
  *
  *******************************************************************************/
 #include "buzzer.h"
+#include "../Tick/tick.h"
+#include <avr/io.h>
+
+/* tone of Buzzer_on */
+#define BUZZER_DEFAULT_TONE BUZZER_TONE(2000)
+
+/*******************************************************************************
+ *                               Pattern table                                 *
+ *******************************************************************************/
+static const Buzzer_NoteType g_click[] = {
+		{ BUZZER_TONE(4000), BUZZER_TIME(10) },
+		{ 0, 0 } };
+static const Buzzer_NoteType g_beep[] = {
+		{ BUZZER_TONE(2000), BUZZER_TIME(150) },
+		{ 0, 0 } };
+static const Buzzer_NoteType g_doubleBeep[] = {
+		{ BUZZER_TONE(2000), BUZZER_TIME(100) },
+		{ BUZZER_REST, BUZZER_TIME(80) },
+		{ BUZZER_TONE(2000), BUZZER_TIME(100) },
+		{ 0, 0 } };
+static const Buzzer_NoteType g_error[] = {
+		{ BUZZER_TONE(600), BUZZER_TIME(400) },
+		{ 0, 0 } };
+/* rising sweep and a short gap, repeated until Buzzer_off */
+static const Buzzer_NoteType g_alarm[] = {
+		{ BUZZER_TONE(800), BUZZER_TIME(60) },
+		{ BUZZER_TONE(1000), BUZZER_TIME(60) },
+		{ BUZZER_TONE(1300), BUZZER_TIME(60) },
+		{ BUZZER_TONE(1600), BUZZER_TIME(60) },
+		{ BUZZER_TONE(2000), BUZZER_TIME(60) },
+		{ BUZZER_TONE(2500), BUZZER_TIME(60) },
+		{ BUZZER_REST, BUZZER_TIME(100) },
+		{ BUZZER_LOOP, 0 } };
+
+/* indexed by Buzzer_Pattern */
+static const Buzzer_NoteType *const g_patterns[] = { g_click, g_beep,
+		g_doubleBeep, g_error, g_alarm };
+
+static const Buzzer_NoteType *g_pattern = NULL_PTR; /* first note of the pattern playing */
+static const Buzzer_NoteType *g_note = NULL_PTR; /* note playing now, NULL_PTR when idle */
+static uint32 g_noteStart; /* time the current note started */
+
+/*
+ * Description:
+ * Output a tone on OC2 or silence the pin for BUZZER_REST
+ */
+static void Buzzer_tone(uint8 tone) {
+	if (tone == BUZZER_REST) {
+		/* OC2 disconnected -> the pin follows PORTD7 which is low */
+		TCCR2 = 0;
+		return;
+	}
+	/* restart the count so a lower compare value doesn't wait for the counter to wrap */
+	TCNT2 = 0;
+	OCR2 = tone;
+	if (TCCR2 == 0) {
+		/*
+		 * Configure timer control register
+		 * 1. Non PWM mode FOC2=1
+		 * 2. CTC Mode WGM21=1 & WGM20=0
+		 * 3. Toggle OC2 on compare match COM20=1 & COM21=0
+		 * 4. clock = F_CPU/64 CS22=1 CS21=0 CS20=0
+		 */
+		TCCR2 = (1 << FOC2) | (1 << WGM21) | (1 << COM20) | (1 << CS22);
+	}
+}
+/*
+ * Description:
+ * Start the note g_note points to, following a loop marker or ending the pattern
+ */
+static void Buzzer_startNote(void) {
+	if (g_note->duration == 0) {
+		if (g_note->tone != BUZZER_LOOP) {
+			Buzzer_off();
+			return;
+		}
+		g_note = g_pattern;
+	}
+	g_noteStart = Tick_millis();
+	Buzzer_tone(g_note->tone);
+}
+
 /*
  * Description:
  * function to initialize buzzer by :
@@ -21,19 +103,46 @@ void Buzzer_init() {
 	GPIO_setupPinDirection(BUZZER_PORT_ID,BUZZER_PIN_ID,PIN_OUTPUT);
 	/*Initially turning off the buzzer*/
 	GPIO_writePin(BUZZER_PORT_ID,BUZZER_PIN_ID,LOGIC_LOW);
+	TCCR2 = 0;
 }
 /*
  * Description:
- * function to turn the buzzer on
+ * function to turn the buzzer on with a continuous tone
  */
 void Buzzer_on() {
-	GPIO_writePin(BUZZER_PORT_ID,BUZZER_PIN_ID,LOGIC_HIGH);
+	g_note = NULL_PTR;
+	Buzzer_tone(BUZZER_DEFAULT_TONE);
 }
 /*
  * Description:
- * function to turn the buzzer off
+ * function to turn the buzzer off, it also stops any pattern
  */
 void Buzzer_off() {
-	GPIO_writePin(BUZZER_PORT_ID,BUZZER_PIN_ID,LOGIC_LOW);
+	g_note = NULL_PTR;
+	Buzzer_tone(BUZZER_REST);
+}
+/*
+ * Description:
+ * Start playing a pattern, it replaces the one playing now
+ * the tone is generated by the timer, Buzzer_update only moves between notes
+ */
+void Buzzer_play(Buzzer_Pattern pattern) {
+	g_pattern = g_patterns[pattern];
+	g_note = g_pattern;
+	Buzzer_startNote();
+}
+/*
+ * Description:
+ * Move to the next note when the current one is over
+ * to be called from the main loop
+ */
+void Buzzer_update(void) {
+	if (g_note == NULL_PTR) {
+		return;
+	}
+	if ((Tick_millis() - g_noteStart)
+			>= (uint16) g_note->duration * BUZZER_TIME_UNIT_MS) {
+		g_note++;
+		Buzzer_startNote();
+	}
 }
-
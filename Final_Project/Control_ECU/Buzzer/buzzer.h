@@ -17,8 +17,45 @@
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
-#define BUZZER_PORT_ID PORTA_ID
-#define BUZZER_PIN_ID PIN0_ID
+/* the buzzer is driven by the Timer2 compare output OC2 */
+#define BUZZER_PORT_ID PORTD_ID
+#define BUZZER_PIN_ID PIN7_ID
+
+/*
+ * Timer2 toggles OC2 on every compare match in CTC mode:
+ * F_TONE = F_CPU / (2 * N * (1 + OCR2)) with N = 64
+ * so the tones go from 245Hz to a few kHz at 8MHz
+ */
+#define BUZZER_PRESCALER 64
+#define BUZZER_TONE(hz) ((uint8) ((F_CPU / (2UL * BUZZER_PRESCALER * (hz))) - 1))
+
+/* note durations are kept in 10ms units */
+#define BUZZER_TIME_UNIT_MS 10
+#define BUZZER_TIME(ms) ((uint8) ((ms) / BUZZER_TIME_UNIT_MS))
+
+/* tone value of a silent note */
+#define BUZZER_REST 0
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+/*
+ * One note of a pattern: the OCR2 value of the tone (BUZZER_REST for silence)
+ * and the duration in BUZZER_TIME units
+ * a note with duration 0 ends the pattern, if its tone is BUZZER_LOOP the
+ * pattern starts again from its first note
+ */
+typedef struct {
+	uint8 tone;
+	uint8 duration;
+} Buzzer_NoteType;
+
+#define BUZZER_LOOP 1
+
+typedef enum {
+	BUZZER_CLICK, BUZZER_BEEP, BUZZER_DOUBLE_BEEP, BUZZER_ERROR, BUZZER_ALARM
+} Buzzer_Pattern;
+
 /*******************************************************************************
  *                              Functions Prototypes                           *
  *******************************************************************************/
@@ -31,13 +68,25 @@
 void Buzzer_init();
 /*
  * Description:
- * function to turn the buzzer on
+ * function to turn the buzzer on with a continuous tone
  */
 void Buzzer_on();
 /*
  * Description:
- * function to turn the buzzer off
+ * function to turn the buzzer off, it also stops any pattern
  */
 void Buzzer_off();
+/*
+ * Description:
+ * Start playing a pattern, it replaces the one playing now
+ * the tone is generated by the timer, Buzzer_update only moves between notes
+ */
+void Buzzer_play(Buzzer_Pattern pattern);
+/*
+ * Description:
+ * Move to the next note when the current one is over
+ * to be called from the main loop
+ */
+void Buzzer_update(void);
 
 #endif /* BUZZER_BUZZER_H_ */
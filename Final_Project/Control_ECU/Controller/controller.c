@@ -0,0 +1,98 @@
+/******************************************************************************
+ *
+ * Module: Controller
+ *
+ * File Name: controller.c
+ *
+ * Description: Source file for the door position controller and door model
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "controller.h"
+#include "../Door/door.h"
+#include "../Motor/motor.h"
+
+/*
+ * Description:
+ * Start a move from position to target at the minimum speed
+ * returns the first signed duty cycle to drive the motor with
+ */
+sint16 Controller_start(Controller_StateType *state, sint16 position,
+		sint16 target) {
+	/* let the velocity loop bring the speed up from the minimum */
+	state->target = target;
+	state->lastPosition = position;
+	state->command = (target > position) ? DOOR_MIN_SPEED : -DOOR_MIN_SPEED;
+	return state->command;
+}
+/*
+ * Description:
+ * Run one control period with the measured position
+ * returns TRUE when the door is within the tolerance of the target,
+ * otherwise the new signed duty cycle is left in state->command
+ */
+uint8 Controller_update(Controller_StateType *state, sint16 position) {
+	sint16 error = state->target - position;
+	sint16 velocity = position - state->lastPosition;
+	sint16 targetVelocity;
+
+	state->lastPosition = position;
+	if ((error <= DOOR_POSITION_TOLERANCE)
+			&& (error >= -DOOR_POSITION_TOLERANCE)) {
+		return TRUE;
+	}
+
+	/* position loop: slow down proportionally to the remaining distance */
+	targetVelocity = error >> DOOR_POSITION_GAIN_SHIFT;
+	if (targetVelocity > DOOR_MAX_VELOCITY)
+		targetVelocity = DOOR_MAX_VELOCITY;
+	else if (targetVelocity < -DOOR_MAX_VELOCITY)
+		targetVelocity = -DOOR_MAX_VELOCITY;
+	else if (targetVelocity == 0)
+		targetVelocity = (error > 0) ? 1 : -1;
+
+	/* velocity loop: integrate the velocity error into the duty cycle */
+	state->command += (targetVelocity - velocity) * DOOR_VELOCITY_GAIN;
+	if (state->command > MOTOR_FULL_SPEED)
+		state->command = MOTOR_FULL_SPEED;
+	else if (state->command < -MOTOR_FULL_SPEED)
+		state->command = -MOTOR_FULL_SPEED;
+	else if (error > 0 && state->command < DOOR_MIN_SPEED)
+		state->command = DOOR_MIN_SPEED;
+	else if (error < 0 && state->command > -DOOR_MIN_SPEED)
+		state->command = -DOOR_MIN_SPEED;
+	return FALSE;
+}
+/*
+ * Description:
+ * Move the door model by one control period driven by a signed duty cycle
+ * the speed follows the duty cycle with a first order lag of 4 periods
+ */
+void Controller_simulate(Controller_PlantType *plant, sint16 command) {
+	sint16 driven = (command * DOOR_MAX_VELOCITY * 16) / MOTOR_FULL_SPEED;
+	sint16 whole;
+
+	plant->velocity += (driven - plant->velocity) / 4;
+	plant->fraction += plant->velocity;
+	whole = plant->fraction / 16;
+	plant->fraction -= whole * 16;
+	plant->position += whole;
+}
+/*
+ * Description:
+ * Estimate the position of a door moving at full speed from start to target
+ * for elapsed_ms, it stops at the target
+ */
+sint16 Controller_estimate(sint16 start, sint16 target, uint32 elapsed_ms) {
+	uint32 moved;
+	uint16 distance = (target > start) ? (target - start) : (start - target);
+
+	if (elapsed_ms >= CONTROLLER_TRAVEL_MS)
+		return target;
+	moved = (elapsed_ms * (DOOR_OPEN_POSITION - DOOR_CLOSED_POSITION))
+			/ CONTROLLER_TRAVEL_MS;
+	if (moved >= distance)
+		return target;
+	return (target > start) ? (start + (sint16) moved) : (start - (sint16) moved);
+}
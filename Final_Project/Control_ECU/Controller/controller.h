@@ -0,0 +1,73 @@
+/******************************************************************************
+ *
+ * Module: Controller
+ *
+ * File Name: controller.h
+ *
+ * Description: Header file for the door position controller and door model,
+ *              plain C with no register access so it also runs on the host
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef CONTROLLER_CONTROLLER_H_
+#define CONTROLLER_CONTROLLER_H_
+
+#include "../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Time the door takes for the whole travel at full speed, used to estimate
+ * the position when there is no position feedback
+ */
+#define CONTROLLER_TRAVEL_MS 15000
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+typedef struct {
+	sint16 target;
+	sint16 lastPosition;
+	sint16 command; /* signed duty cycle, positive opens the door */
+} Controller_StateType;
+
+typedef struct {
+	sint16 position; /* in encoder counts */
+	sint16 velocity; /* in 1/16 counts per period */
+	sint16 fraction; /* position below one count in 1/16 counts */
+} Controller_PlantType;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Start a move from position to target at the minimum speed
+ * returns the first signed duty cycle to drive the motor with
+ */
+sint16 Controller_start(Controller_StateType *state, sint16 position,
+		sint16 target);
+/*
+ * Description:
+ * Run one control period with the measured position
+ * returns TRUE when the door is within the tolerance of the target,
+ * otherwise the new signed duty cycle is left in state->command
+ */
+uint8 Controller_update(Controller_StateType *state, sint16 position);
+/*
+ * Description:
+ * Move the door model by one control period driven by a signed duty cycle
+ * the speed follows the duty cycle with a first order lag of 4 periods
+ */
+void Controller_simulate(Controller_PlantType *plant, sint16 command);
+/*
+ * Description:
+ * Estimate the position of a door moving at full speed from start to target
+ * for elapsed_ms, it stops at the target
+ */
+sint16 Controller_estimate(sint16 start, sint16 target, uint32 elapsed_ms);
+
+#endif /* CONTROLLER_CONTROLLER_H_ */
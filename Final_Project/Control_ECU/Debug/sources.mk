@@ -20,12 +20,21 @@ C_DEPS :=
 # Every subdirectory with source files must be described here
 SUBDIRS := \
 Buzzer \
+Controller \
+Diag \
+Door \
 EEPROM \
 GPIO \
+MEM \
 Motor \
+Power \
+Sequence \
+Status \
 TWI \
+Tick \
 Timer \
 Timer0 \
+Trace \
 UART \
 . \
 
@@ -0,0 +1,50 @@
+/******************************************************************************
+ *
+ * Module: Diag
+ *
+ * File Name: diag.h
+ *
+ * Description: Header file for the link diagnostic commands
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef DIAG_DIAG_H_
+#define DIAG_DIAG_H_
+
+#include "../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * A diagnostic request is DIAG_REQUEST followed by the id of the requested block
+ * the reply is DIAG_REQUEST, the id, the length and then the block bytes "little endian"
+ * an unknown id is answered with a zero length block
+ */
+#define DIAG_REQUEST 'G'
+#define DIAG_LINK_STATS 'L'  /* UART_StatsType counters */
+#define DIAG_TRACE 'T'       /* Trace_EntryType entries from the oldest, the ring is cleared after it */
+#define DIAG_MEMORY 'M'      /* MEM_UsageType RAM and stack usage */
+#define DIAG_POWER 'P'       /* Power_StatsType sleep statistics */
+
+/* maximum time to wait for each byte of a diagnostic request or reply */
+#define DIAG_TIMEOUT_MS 200
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Answer a diagnostic request, called after DIAG_REQUEST is received
+ */
+void Diag_handleRequest(void);
+/*
+ * Description:
+ * Ask the other ECU for a diagnostic block and copy it to data
+ * returns the length of the block or 0 if there is no valid reply
+ */
+uint8 Diag_request(uint8 id, uint8 *data, uint8 size);
+
+#endif /* DIAG_DIAG_H_ */
@@ -0,0 +1,204 @@
+/******************************************************************************
+ *
+ * Module: Door
+ *
+ * File Name: door.c
+ *
+ * Description: Source file for the door position control
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "door.h"
+#include "../common_macros.h"
+#include "../Motor/motor.h"
+#include "../Tick/tick.h"
+#include "../Controller/controller.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+static const DCMotor_ProfileType g_doorProfile = { MOTOR_S_CURVE,
+		DOOR_ACCELERATION, DOOR_DECELERATION };
+
+static volatile sint16 g_position = DOOR_CLOSED_POSITION;
+static sint16 g_target = DOOR_CLOSED_POSITION;
+static uint8 g_moving = FALSE;
+static uint32 g_lastUpdate;
+
+#if (DOOR_FEEDBACK == DOOR_FEEDBACK_ENCODER) || (DOOR_FEEDBACK == DOOR_FEEDBACK_SIMULATED)
+static Controller_StateType g_controller;
+#elif DOOR_FEEDBACK == DOOR_FEEDBACK_NONE
+static sint16 g_start; /* position the running move started from */
+static uint32 g_moveStart; /* time the running move started */
+#endif
+
+#if DOOR_FEEDBACK == DOOR_FEEDBACK_ENCODER
+static volatile uint8 g_encoderState;
+/*
+ * Position change for every transition of the encoder channels
+ * index = previous state << 2 | new state, where state = B << 1 | A
+ * the opening sequence is 00 -> 01 -> 11 -> 10 -> 00
+ */
+static const sint8 g_encoderSteps[16] = { 0, 1, -1, 0, -1, 0, 0, 1, 1, 0, 0,
+		-1, 0, -1, 1, 0 };
+
+static void Door_encoderUpdate(void) {
+	uint8 state = (PIND >> PD2) & 0x03;
+	g_position += g_encoderSteps[(g_encoderState << 2) | state];
+	g_encoderState = state;
+}
+
+/*
+ * ISRs for any edge on the encoder channels
+ */
+ISR(INT0_vect) {
+	Door_encoderUpdate();
+}
+ISR(INT1_vect) {
+	Door_encoderUpdate();
+}
+#endif
+
+#if DOOR_FEEDBACK == DOOR_FEEDBACK_SIMULATED
+static Controller_PlantType g_plant;
+/*
+ * Description:
+ * Move the simulated door by one control period with the motor output
+ */
+static void Door_simulate(void) {
+	sint16 duty = DCMotor_getSpeed();
+	switch (DCMotor_getDirection()) {
+	case CLOCK_WISE:
+		break;
+	case ANTI_CLOCK_WISE:
+		duty = -duty;
+		break;
+	default:
+		duty = 0;
+		break;
+	}
+	Controller_simulate(&g_plant, duty);
+	g_position = g_plant.position;
+}
+#endif
+
+/*
+ * Description:
+ * Set up the selected feedback input, the door is assumed closed at start up
+ */
+void Door_init(void) {
+#if DOOR_FEEDBACK == DOOR_FEEDBACK_ENCODER
+	/* PD2 and PD3 inputs with pull ups, interrupt on any edge of INT0 and INT1 */
+	DDRD &= ~((1 << PD2) | (1 << PD3));
+	PORTD |= (1 << PD2) | (1 << PD3);
+	g_encoderState = (PIND >> PD2) & 0x03;
+	MCUCR = (MCUCR & 0xF0) | (1 << ISC10) | (1 << ISC00);
+	GIFR = (1 << INTF0) | (1 << INTF1);
+	GICR |= (1 << INT0) | (1 << INT1);
+#elif DOOR_FEEDBACK == DOOR_FEEDBACK_LIMIT_SWITCHES
+	/* the switches are only polled by Door_update */
+	DDRD &= ~((1 << PD2) | (1 << PD3));
+	PORTD |= (1 << PD2) | (1 << PD3);
+#endif
+	DCMotor_setProfile(&g_doorProfile);
+	g_position = DOOR_CLOSED_POSITION;
+}
+/*
+ * Description:
+ * Start moving the door to the target position
+ */
+void Door_moveTo(sint16 target) {
+	sint16 position = Door_getPosition();
+	DCMotorState direction = (target > position) ? CLOCK_WISE : ANTI_CLOCK_WISE;
+
+	g_target = target;
+	g_moving = TRUE;
+	g_lastUpdate = Tick_millis();
+#if (DOOR_FEEDBACK == DOOR_FEEDBACK_ENCODER) || (DOOR_FEEDBACK == DOOR_FEEDBACK_SIMULATED)
+	Controller_start(&g_controller, position, target);
+	DCMotor_move(direction, DOOR_MIN_SPEED);
+#else
+#if DOOR_FEEDBACK == DOOR_FEEDBACK_NONE
+	/* nothing reports the position so it is estimated from the time moving */
+	g_start = position;
+	g_moveStart = g_lastUpdate;
+#endif
+	DCMotor_move(direction, MOTOR_FULL_SPEED);
+#endif
+}
+/*
+ * Description:
+ * Ramp the motor down and drop the current target
+ * does nothing if the door already reached it
+ */
+void Door_stop(void) {
+	/* a door that arrived is already braked */
+	if (g_moving) {
+#if DOOR_FEEDBACK == DOOR_FEEDBACK_NONE
+		g_position = Door_getPosition();
+#endif
+		g_moving = FALSE;
+		DCMotor_stop(MOTOR_STOP_RAMP);
+	}
+}
+/*
+ * Description:
+ * Run the position controller, to be called from the main loop
+ * returns TRUE once when the door reached its target and the motor is braked
+ * always returns FALSE without position feedback
+ */
+uint8 Door_update(void) {
+	uint8 arrived;
+	if (!g_moving)
+		return FALSE;
+	if ((Tick_millis() - g_lastUpdate) < DOOR_CONTROL_PERIOD_MS)
+		return FALSE;
+	g_lastUpdate += DOOR_CONTROL_PERIOD_MS;
+
+#if DOOR_FEEDBACK == DOOR_FEEDBACK_NONE
+	arrived = FALSE;
+#elif DOOR_FEEDBACK == DOOR_FEEDBACK_LIMIT_SWITCHES
+	/* the switch at the end the door is heading to closes to ground */
+	if (g_target == DOOR_CLOSED_POSITION)
+		arrived = BIT_IS_CLEAR(PIND, PD3);
+	else
+		arrived = BIT_IS_CLEAR(PIND, PD2);
+	if (arrived)
+		g_position = g_target;
+#else
+#if DOOR_FEEDBACK == DOOR_FEEDBACK_SIMULATED
+	Door_simulate();
+#endif
+	arrived = Controller_update(&g_controller, Door_getPosition());
+	if (!arrived) {
+		if (g_controller.command > 0)
+			DCMotor_move(CLOCK_WISE, g_controller.command);
+		else
+			DCMotor_move(ANTI_CLOCK_WISE, -g_controller.command);
+	}
+#endif
+	if (arrived) {
+		g_moving = FALSE;
+		DCMotor_stop(MOTOR_STOP_BRAKE);
+	}
+	return arrived;
+}
+/*
+ * Description:
+ * Returns the last known door position
+ * without position feedback it is estimated from the time the door has moved
+ */
+sint16 Door_getPosition(void) {
+	sint16 position;
+	uint8 sreg;
+#if DOOR_FEEDBACK == DOOR_FEEDBACK_NONE
+	if (g_moving)
+		return Controller_estimate(g_start, g_target, Tick_millis() - g_moveStart);
+#endif
+	sreg = SREG;
+	/* the encoder interrupts update the position */
+	cli();
+	position = g_position;
+	SREG = sreg;
+	return position;
+}
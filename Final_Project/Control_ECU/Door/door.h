@@ -0,0 +1,99 @@
+/******************************************************************************
+ *
+ * Module: Door
+ *
+ * File Name: door.h
+ *
+ * Description: Header file for the door position control
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef DOOR_DOOR_H_
+#define DOOR_DOOR_H_
+
+#include "../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Position feedback, select one with -DDOOR_FEEDBACK=...
+ * NONE: no sensor, the application ends each motion on time
+ * ENCODER: quadrature encoder, channel A on PD2/INT0 and channel B on PD3/INT1
+ *          (swap the channels if the door counts backwards)
+ * LIMIT_SWITCHES: open end switch on PD2 and closed end switch on PD3,
+ *          active low with the internal pull ups
+ * SIMULATED: the door model of Controller/controller.h updated by Door_update,
+ *          it needs no hardware (Tools/door_test.c runs the same model and
+ *          controller on the host)
+ */
+#define DOOR_FEEDBACK_NONE 0
+#define DOOR_FEEDBACK_ENCODER 1
+#define DOOR_FEEDBACK_LIMIT_SWITCHES 2
+#define DOOR_FEEDBACK_SIMULATED 3
+
+#ifndef DOOR_FEEDBACK
+#define DOOR_FEEDBACK DOOR_FEEDBACK_NONE
+#endif
+
+/* positions in encoder counts */
+#define DOOR_CLOSED_POSITION 0
+#define DOOR_OPEN_POSITION 6000
+/* the motion is finished when the door is this close to the target */
+#define DOOR_POSITION_TOLERANCE 8
+
+/* the controller runs every DOOR_CONTROL_PERIOD_MS */
+#define DOOR_CONTROL_PERIOD_MS 10
+/*
+ * Position loop: target velocity = position error >> DOOR_POSITION_GAIN_SHIFT
+ * limited to DOOR_MAX_VELOCITY counts per period (full speed of the door)
+ * Velocity loop: the duty cycle moves by DOOR_VELOCITY_GAIN percent per count
+ * of velocity error every period, never below DOOR_MIN_SPEED while moving
+ */
+#define DOOR_POSITION_GAIN_SHIFT 4
+#define DOOR_MAX_VELOCITY 5
+#define DOOR_VELOCITY_GAIN 4
+#define DOOR_MIN_SPEED 20
+/*
+ * Motor ramps of the door: S-curve steps up to 4 percent every ramp period
+ * so the door gets from rest to full speed in about 0.3 second without a current spike
+ */
+#define DOOR_ACCELERATION 4
+#define DOOR_DECELERATION 4
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Set up the selected feedback input, the door is assumed closed at start up
+ */
+void Door_init(void);
+/*
+ * Description:
+ * Start moving the door to the target position
+ */
+void Door_moveTo(sint16 target);
+/*
+ * Description:
+ * Ramp the motor down and drop the current target
+ * does nothing if the door already reached it
+ */
+void Door_stop(void);
+/*
+ * Description:
+ * Run the position controller, to be called from the main loop
+ * returns TRUE once when the door reached its target and the motor is braked
+ * always returns FALSE without position feedback
+ */
+uint8 Door_update(void);
+/*
+ * Description:
+ * Returns the last known door position
+ * without position feedback it is estimated from the time the door has moved
+ */
+sint16 Door_getPosition(void);
+
+#endif /* DOOR_DOOR_H_ */
@@ -11,7 +11,20 @@
  *******************************************************************************/
 #include "../TWI/twi.h"
 #include "eeprom.h"
+#include "../Trace/trace.h"
 #include <util/delay.h>
+
+/* failed byte transfers of the string functions, it stops at 255 */
+static uint8 g_errors = 0;
+
+/*
+ * Description:
+ * count a failed byte transfer
+ */
+static void EEPROM_countError(uint8 status) {
+	if (status == ERROR && g_errors != 0xFF)
+		g_errors++;
+}
 /*
  * Description:
  * A function to write a byte in the external EEPROM in a certain address
@@ -91,11 +104,13 @@ uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data) {
  */
 void EEPROM_writeSting(uint16 u16startAddr, uint8 *u8data) {
 	uint8 i = 0;
+	TRACE_EVENT(TRACE_EEPROM_WRITE_BEGIN, 0);
 	while (u8data[i] != '\0') {
-		EEPROM_writeByte(u16startAddr + i, u8data[i]);
+		EEPROM_countError(EEPROM_writeByte(u16startAddr + i, u8data[i]));
 		_delay_ms(10);
 		i++;
 	}
+	TRACE_EVENT(TRACE_EEPROM_WRITE_END, i);
 }
 /*
  * Description:
@@ -103,10 +118,19 @@ void EEPROM_writeSting(uint16 u16startAddr, uint8 *u8data) {
  */
 void EEPROM_readString(uint16 u16startAddr, uint8 *u8data, uint8 bytesNumber) {
 	uint8 i = 0;
+	TRACE_EVENT(TRACE_EEPROM_READ_BEGIN, bytesNumber);
 	while (i < bytesNumber) {
-		EEPROM_readByte(u16startAddr + i, &u8data[i]);
+		EEPROM_countError(EEPROM_readByte(u16startAddr + i, &u8data[i]));
 		_delay_ms(10);
 		i++;
 	}
 	u8data[i] = '\0';
+	TRACE_EVENT(TRACE_EEPROM_READ_END, bytesNumber);
+}
+/*
+ * Description:
+ * Returns the number of bytes the string functions failed to transfer
+ */
+uint8 EEPROM_getErrors(void) {
+	return g_errors;
 }
@@ -44,5 +44,10 @@ uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data);
  * A function to read a String with a certain size from the external EEPROM from a certain address
  */
 void EEPROM_readString(uint16 u16startAddr, uint8 * u8data, uint8 bytesNumber);
+/*
+ * Description:
+ * Returns the number of bytes the string functions failed to transfer
+ */
+uint8 EEPROM_getErrors(void);
 
 #endif /* EEPROM_EEPROM_H_ */
@@ -0,0 +1,69 @@
+/******************************************************************************
+ *
+ * Module: MEM
+ *
+ * File Name: mem.c
+ *
+ * Description: Source file for the RAM and stack usage monitor
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "mem.h"
+#include <avr/io.h>
+
+/*
+ * Linker symbols:
+ * __heap_start is the first byte after .bss
+ * __stack is the top of the RAM where the stack starts
+ */
+extern uint8 __heap_start;
+extern uint8 __stack;
+
+/* first address of the internal SRAM of the ATmega32 if the device header doesn't define it */
+#ifndef RAMSTART
+#define RAMSTART 0x60
+#endif
+
+/*
+ * Description:
+ * Paint the RAM from the end of .bss to the top of the stack with MEM_PAINT_VALUE
+ * it is placed in .init1 so it runs right after reset before anything uses the stack
+ * it is written in assembly as the stack and the registers are not set up yet at this stage
+ */
+void MEM_paintStack(void) __attribute__ ((naked, used, section (".init1")));
+void MEM_paintStack(void) {
+	__asm__ __volatile__ (
+			"    ldi r30, lo8(__heap_start)\n"
+			"    ldi r31, hi8(__heap_start)\n"
+			"    ldi r24, %0\n"
+			"    ldi r25, hi8(__stack)\n"
+			"    rjmp 2f\n"
+			"1:  st Z+, r24\n"
+			"2:  cpi r30, lo8(__stack)\n"
+			"    cpc r31, r25\n"
+			"    brlo 1b\n"
+			"    breq 1b\n"
+			:
+			: "i" (MEM_PAINT_VALUE));
+}
+
+/*
+ * Description:
+ * Report the RAM usage and the stack high water mark
+ */
+void MEM_highWater(MEM_UsageType *usage) {
+	uint8 *p = &__heap_start;
+	uint16 stackTop = (uint16) &__stack;
+	uint16 heapStart = (uint16) &__heap_start;
+
+	/* the first byte that lost its paint is the deepest point the stack reached */
+	while (*p == MEM_PAINT_VALUE && (uint16) p < SP) {
+		p++;
+	}
+	usage->static_size = heapStart - RAMSTART;
+	usage->stack_now = stackTop - SP;
+	usage->stack_peak = stackTop - (uint16) p + 1;
+	usage->free_now = SP - heapStart;
+	usage->free_min = (uint16) p - heapStart;
+}
@@ -0,0 +1,48 @@
+/******************************************************************************
+ *
+ * Module: MEM
+ *
+ * File Name: mem.h
+ *
+ * Description: Header file for the RAM and stack usage monitor
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef MEM_MEM_H_
+#define MEM_MEM_H_
+
+#include "../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * value written to the whole free RAM before main
+ * a byte that still has this value was never used by the stack
+ */
+#define MEM_PAINT_VALUE 0xC5
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+typedef struct {
+	uint16 static_size;  /* .data and .bss bytes */
+	uint16 stack_now;    /* current stack depth in bytes */
+	uint16 stack_peak;   /* deepest stack depth since reset in bytes */
+	uint16 free_now;     /* bytes between the end of .bss and the stack pointer */
+	uint16 free_min;     /* bytes between the end of .bss and the deepest stack */
+} MEM_UsageType;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Report the RAM usage and the stack high water mark
+ * the free RAM is painted with MEM_PAINT_VALUE at startup before main is called
+ */
+void MEM_highWater(MEM_UsageType *usage);
+
+#endif /* MEM_MEM_H_ */
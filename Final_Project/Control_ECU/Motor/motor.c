@@ -13,18 +13,163 @@
 #include "../GPIO/gpio.h"
 #include "motor.h"
 #include "../Timer0/timer0.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/* Fast PWM with F_CPU/64 -> 488Hz at 8MHz */
+static const Timer0_ConfigType g_motorPwmConfig = { TIMER0_FAST_PWM, TIMER0_F_CPU_64 };
+
+static DCMotor_ProfileType g_profile = { MOTOR_TRAPEZOID,
+		MOTOR_DEFAULT_ACCELERATION, MOTOR_DEFAULT_DECELERATION };
+
+/*
+ * Ramp state shared with the Timer0 overflow interrupt
+ * g_direction is the direction the bridge is driven in now
+ * g_nextDirection and g_targetSpeed are what the ramp is heading for
+ */
+static volatile DCMotorState g_direction = STOP;
+static volatile DCMotorState g_nextDirection = STOP;
+static volatile uint8 g_speed = 0;
+static volatile uint8 g_targetSpeed = 0;
+static volatile uint8 g_step = 0; /* current speed change per step for the S-curve */
+static volatile uint8 g_overflows = 0;
+static volatile uint8 g_settled = TRUE;
+static volatile uint8 g_pwmOn = FALSE; /* Timer0 runs only while the bridge is driven */
+
+/*
+ * Description:
+ * Drive the bridge inputs for the required direction
+ * STOP releases both inputs so the motor coasts
+ */
+static void DCMotor_setDirection(DCMotorState state) {
+	switch (state) {
+	case STOP:
+		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_1_ID, LOGIC_LOW);
+		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_2_ID, LOGIC_LOW);
+		break;
+	case CLOCK_WISE:
+		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_1_ID, LOGIC_HIGH);
+		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_2_ID, LOGIC_LOW);
+		break;
+	case ANTI_CLOCK_WISE:
+		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_1_ID, LOGIC_LOW);
+		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_2_ID, LOGIC_HIGH);
+		break;
+	}
+	g_direction = state;
+}
+/*
+ * Description:
+ * Start the PWM timer if the bridge was released, the duty cycle starts at 0%
+ */
+static void DCMotor_startPwm(void) {
+	if (!g_pwmOn) {
+		PWM_Timer0_init(&g_motorPwmConfig);
+		g_pwmOn = TRUE;
+	}
+}
+/*
+ * Description:
+ * Release both bridge inputs and stop Timer0 so the enable pin is low
+ * and the motor coasts with the bridge off
+ */
+static void DCMotor_release(void) {
+	DCMotor_setDirection(STOP);
+	PWM_Timer0_stop();
+	g_pwmOn = FALSE;
+	g_speed = 0;
+}
+/*
+ * Description:
+ * Speed change for the next ramp step towards a speed that is remaining percent away
+ */
+static uint8 DCMotor_rampStep(uint8 rate, uint8 remaining) {
+	uint8 step;
+	if (rate == 0) {
+		return remaining;
+	}
+	if (g_profile.shape == MOTOR_S_CURVE) {
+		/*
+		 * reduce the step once the remaining distance is what it takes to bring
+		 * the step back to zero (step + (step - 1) + ... + 1), else grow it up to the rate
+		 */
+		if (remaining <= ((uint16) g_step * (g_step + 1)) / 2) {
+			if (g_step > 1) {
+				g_step--;
+			}
+		} else if (g_step < rate) {
+			g_step++;
+		}
+		step = g_step;
+	} else {
+		step = rate;
+	}
+	return (step < remaining) ? step : remaining;
+}
+/*
+ * Description:
+ * Ramp engine called at the end of every PWM period
+ * every MOTOR_RAMP_PERIOD_OVERFLOWS periods it moves the speed one step
+ * towards the target and writes the new duty cycle
+ */
+static void DCMotor_rampUpdate(void) {
+	uint8 target;
+	if (++g_overflows < MOTOR_RAMP_PERIOD_OVERFLOWS) {
+		return;
+	}
+	g_overflows = 0;
+
+	/* a direction change has to pass through zero speed first */
+	target = (g_direction == g_nextDirection) ? g_targetSpeed : 0;
+
+	if (g_speed == target) {
+		if (g_direction != g_nextDirection) {
+			DCMotor_setDirection(g_nextDirection);
+			g_step = 0;
+			return;
+		}
+		if (g_speed == 0) {
+			DCMotor_release();
+		}
+		/* nothing left to do until the next request */
+		g_settled = TRUE;
+		PWM_Timer0_setCallBack(NULL_PTR);
+		return;
+	}
+	if (g_speed < target) {
+		g_speed += DCMotor_rampStep(g_profile.acceleration, target - g_speed);
+	} else {
+		g_speed -= DCMotor_rampStep(g_profile.deceleration, g_speed - target);
+	}
+	PWM_Timer0_setDuty(g_speed);
+}
+/*
+ * Description:
+ * Called at the end of every PWM period while the motor brakes
+ * releases the bridge after MOTOR_BRAKE_OVERFLOWS periods
+ */
+static void DCMotor_brakeUpdate(void) {
+	if (++g_overflows < MOTOR_BRAKE_OVERFLOWS) {
+		return;
+	}
+	DCMotor_release();
+	g_settled = TRUE;
+	PWM_Timer0_setCallBack(NULL_PTR);
+}
 
 /*
  * Description:
  * initializing motor pins to be output
  * stop the motor at the beginning
+ * configure the PWM timer once, speed changes only update the duty cycle
  */
 void DCMotor_init(void) {
 	GPIO_setupPinDirection(MOTOR_PORT_ID, MOTOR_PIN_1_ID, PIN_OUTPUT);
 	GPIO_setupPinDirection(MOTOR_PORT_ID, MOTOR_PIN_2_ID, PIN_OUTPUT);
 
-	GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_1_ID, LOGIC_LOW);
-	GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_2_ID, LOGIC_LOW);
+	/* PWM_Timer0_init makes PB3/OC0 an output so the enable pin is held low while released */
+	PWM_Timer0_init(&g_motorPwmConfig);
+	DCMotor_release();
 }
 /*
  * Description:
@@ -32,22 +177,126 @@ void DCMotor_init(void) {
  * stop the motor based on the state input state value.
  * Send the required duty cycle to the PWM driver based on the
  * required speed value.
+ * the change is immediate and cancels any running ramp
  */
 void DCMotor_rotate(DCMotorState state, uint8 speed) {
-	switch (state) {
-	case STOP:
-		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_1_ID, LOGIC_LOW);
-		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_2_ID, LOGIC_LOW);
+	uint8 sreg = SREG;
+	cli();
+	PWM_Timer0_setCallBack(NULL_PTR);
+	if (state == STOP) {
+		DCMotor_release();
+		speed = 0;
+	} else {
+		DCMotor_startPwm();
+		DCMotor_setDirection(state);
+		PWM_Timer0_setDuty(speed);
+	}
+	g_speed = speed;
+	g_targetSpeed = speed;
+	g_nextDirection = state;
+	g_settled = TRUE;
+	SREG = sreg;
+}
+/*
+ * Description:
+ * Select the ramp shape and acceleration used by DCMotor_move and DCMotor_stop
+ */
+void DCMotor_setProfile(const DCMotor_ProfileType *profile) {
+	uint8 sreg = SREG;
+	cli();
+	g_profile = *profile;
+	SREG = sreg;
+}
+/*
+ * Description:
+ * Ramp the motor to the required speed in the required direction
+ * if the motor turns the other way it decelerates to zero first
+ * returns immediately, the ramp runs from the Timer0 overflow interrupt
+ */
+void DCMotor_move(DCMotorState direction, uint8 speed) {
+	uint8 sreg = SREG;
+	if (direction == STOP) {
+		DCMotor_stop(MOTOR_STOP_RAMP);
+		return;
+	}
+	if (speed > MOTOR_FULL_SPEED) {
+		speed = MOTOR_FULL_SPEED;
+	}
+	cli();
+	if (g_direction == STOP) {
+		/* starting from rest, or from a brake that holds the duty at 100% */
+		DCMotor_startPwm();
+		g_speed = 0;
+		PWM_Timer0_setDuty(0);
+		DCMotor_setDirection(direction);
+		/* a brake in progress is replaced by the ramp */
+		g_settled = TRUE;
+	}
+	g_nextDirection = direction;
+	g_targetSpeed = speed;
+	if (g_settled) {
+		g_settled = FALSE;
+		g_step = 0;
+		g_overflows = 0;
+		PWM_Timer0_setCallBack(DCMotor_rampUpdate);
+	}
+	SREG = sreg;
+}
+/*
+ * Description:
+ * Stop the motor with the required stop type
+ */
+void DCMotor_stop(DCMotor_StopType type) {
+	uint8 sreg = SREG;
+	switch (type) {
+	case MOTOR_STOP_RAMP:
+		cli();
+		g_targetSpeed = 0;
+		g_nextDirection = g_direction;
+		if (g_settled && g_speed != 0) {
+			g_settled = FALSE;
+			g_step = 0;
+			g_overflows = 0;
+			PWM_Timer0_setCallBack(DCMotor_rampUpdate);
+		} else if (g_settled) {
+			/* already at rest, make sure the bridge and the timer are off */
+			DCMotor_release();
+		}
+		/* a brake in progress releases the bridge when it ends */
+		SREG = sreg;
 		break;
-	case CLOCK_WISE:
-		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_1_ID, LOGIC_HIGH);
-		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_2_ID, LOGIC_LOW);
-		PWM_Timer0_Start(speed);
+	case MOTOR_STOP_COAST:
+		DCMotor_rotate(STOP, 0);
 		break;
-	case ANTI_CLOCK_WISE:
-		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_1_ID, LOGIC_LOW);
+	case MOTOR_STOP_BRAKE:
+		/*
+		 * both bridge outputs high with the enable fully on short the motor terminals
+		 * the overflow interrupt releases the bridge when the brake time is over
+		 */
+		DCMotor_rotate(STOP, 0);
+		cli();
+		DCMotor_startPwm();
+		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_1_ID, LOGIC_HIGH);
 		GPIO_writePin(MOTOR_PORT_ID, MOTOR_PIN_2_ID, LOGIC_HIGH);
-		PWM_Timer0_Start(speed);
+		PWM_Timer0_setDuty(MOTOR_FULL_SPEED);
+		g_settled = FALSE;
+		g_overflows = 0;
+		PWM_Timer0_setCallBack(DCMotor_brakeUpdate);
+		SREG = sreg;
+		break;
 	}
-
+}
+/*
+ * Description:
+ * Returns the direction the motor is driven in now
+ */
+DCMotorState DCMotor_getDirection(void) {
+	return g_direction;
+}
+/*
+ * Description:
+ * Returns the duty cycle applied now in percent, it lags the requested speed during a ramp
+ */
+uint8 DCMotor_getSpeed(void) {
+	return g_speed;
 }
@@ -28,6 +28,18 @@
 #define MOTOR_THREE_QUARTERS_SPEED 75
 #define MOTOR_FULL_SPEED 100
 
+/*
+ * The ramp is updated every MOTOR_RAMP_PERIOD_OVERFLOWS PWM periods
+ * 5 periods of 256 * 64 / 8MHz = 10.24 ms
+ * acceleration values are in percent of full speed per ramp step
+ */
+#define MOTOR_RAMP_PERIOD_OVERFLOWS 5
+/* a brake holds the motor terminals shorted for 50 PWM periods ~ 100 ms then releases the bridge */
+#define MOTOR_BRAKE_OVERFLOWS 50
+
+/* default profile: 0 -> full speed in 50 steps ~ 0.5 second */
+#define MOTOR_DEFAULT_ACCELERATION 2
+#define MOTOR_DEFAULT_DECELERATION 2
 
 /*******************************************************************************
  *                               Types Declaration                             *
@@ -36,6 +48,33 @@ typedef enum {
 	STOP , CLOCK_WISE , ANTI_CLOCK_WISE
 }DCMotorState;
 
+/*
+ * MOTOR_TRAPEZOID: the speed changes with a constant acceleration
+ * MOTOR_S_CURVE: the acceleration itself grows by one step at a time up to
+ * the profile value and shrinks again before the target speed is reached
+ */
+typedef enum {
+	MOTOR_TRAPEZOID, MOTOR_S_CURVE
+} DCMotor_RampShape;
+
+/* an acceleration of 0 changes the speed in one step */
+typedef struct {
+	DCMotor_RampShape shape;
+	uint8 acceleration;
+	uint8 deceleration;
+} DCMotor_ProfileType;
+
+/*
+ * MOTOR_STOP_RAMP: decelerate with the profile then coast
+ * MOTOR_STOP_COAST: cut the drive immediately and let the motor spin down
+ * MOTOR_STOP_BRAKE: short the motor through the bridge to stop it quickly
+ *                   for MOTOR_BRAKE_OVERFLOWS periods
+ * the bridge is released and the PWM timer stopped once the motor is at rest
+ */
+typedef enum {
+	MOTOR_STOP_RAMP, MOTOR_STOP_COAST, MOTOR_STOP_BRAKE
+} DCMotor_StopType;
+
 /*******************************************************************************
  *                              Functions Prototypes                           *
  *******************************************************************************/
@@ -43,6 +82,7 @@ typedef enum {
  * Description:
  * initializing motor pins to be output
  * stop the motor at the beginning
+ * configure the PWM timer once, speed changes only update the duty cycle
  */
 void DCMotor_init(void);
 /*
@@ -51,6 +91,34 @@ void DCMotor_init(void);
  * stop the motor based on the state input state value.
  * Send the required duty cycle to the PWM driver based on the
  * required speed value.
+ * the change is immediate and cancels any running ramp
  */
 void DCMotor_rotate(DCMotorState state ,uint8 speed);
+/*
+ * Description:
+ * Select the ramp shape and acceleration used by DCMotor_move and DCMotor_stop
+ */
+void DCMotor_setProfile(const DCMotor_ProfileType *profile);
+/*
+ * Description:
+ * Ramp the motor to the required speed in the required direction
+ * if the motor turns the other way it decelerates to zero first
+ * returns immediately, the ramp runs from the Timer0 overflow interrupt
+ */
+void DCMotor_move(DCMotorState direction, uint8 speed);
+/*
+ * Description:
+ * Stop the motor with the required stop type
+ */
+void DCMotor_stop(DCMotor_StopType type);
+/*
+ * Description:
+ * Returns the direction the motor is driven in now
+ */
+DCMotorState DCMotor_getDirection(void);
+/*
+ * Description:
+ * Returns the duty cycle applied now in percent, it lags the requested speed during a ramp
+ */
+uint8 DCMotor_getSpeed(void);
 #endif /* MOTOR_MOTOR_H_ */
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *
+ * Module: Sequence
+ *
+ * File Name: sequence.c
+ *
+ * Description: Source file for the table driven door and alarm sequences
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "sequence.h"
+#include "../Door/door.h"
+#include "../Buzzer/buzzer.h"
+#include "../Tick/tick.h"
+#include "../Trace/trace.h"
+
+static const Sequence_StepType *g_step = NULL_PTR; /* the running step, NULL_PTR when idle */
+static uint32 g_stepStart; /* time the running step started */
+
+/*
+ * Description:
+ * Apply the actions of the step g_step points to and start timing it
+ */
+static void Sequence_enterStep(void) {
+	g_stepStart = Tick_millis();
+	TRACE_EVENT(TRACE_APP_DOOR_PHASE, g_step->state);
+
+	switch (g_step->action) {
+	case SEQUENCE_NO_ACTION:
+		break;
+	case SEQUENCE_OPEN_DOOR:
+		Door_moveTo(DOOR_OPEN_POSITION);
+		break;
+	case SEQUENCE_CLOSE_DOOR:
+		Door_moveTo(DOOR_CLOSED_POSITION);
+		break;
+	case SEQUENCE_STOP_DOOR:
+		Door_stop();
+		break;
+	case SEQUENCE_ALARM_ON:
+		Buzzer_play(BUZZER_ALARM);
+		break;
+	case SEQUENCE_ALARM_OFF:
+		Buzzer_off();
+		break;
+	}
+}
+
+/*
+ * Description:
+ * Start running a table of steps from its first step
+ * a running sequence is abandoned where it is and its door move is stopped
+ */
+void Sequence_start(const Sequence_StepType *steps) {
+	if (g_step != NULL_PTR) {
+		Door_stop();
+	}
+	g_step = steps;
+	Sequence_enterStep();
+}
+/*
+ * Description:
+ * Move the running sequence on when its step is over
+ * to be called from the main loop
+ */
+void Sequence_update(void) {
+	/* Door_update is the only thing that ends a move early with position feedback */
+	uint8 arrived = Door_update();
+
+	if (g_step == NULL_PTR) {
+		return;
+	}
+	/* an arrival only ends the step that moves the door */
+	if ((Tick_millis() - g_stepStart) < g_step->duration_ms
+			&& !(arrived && (g_step->action == SEQUENCE_OPEN_DOOR
+					|| g_step->action == SEQUENCE_CLOSE_DOOR))) {
+		return;
+	}
+	if (g_step->duration_ms == 0) {
+		/* the last step stayed current until now so its state was seen */
+		g_step = NULL_PTR;
+	} else {
+		g_step++;
+		Sequence_enterStep();
+	}
+}
+/*
+ * Description:
+ * Returns TRUE while a sequence is running
+ */
+uint8 Sequence_isRunning(void) {
+	return (g_step != NULL_PTR);
+}
+/*
+ * Description:
+ * Returns the state of the running step or 0 when no sequence runs
+ */
+uint8 Sequence_getState(void) {
+	return (g_step != NULL_PTR) ? g_step->state : 0;
+}
+/*
+ * Description:
+ * Returns the milliseconds left of the running step or 0 when no sequence runs
+ * a door move may end earlier when the door reaches its position
+ */
+uint16 Sequence_getRemaining(void) {
+	uint32 elapsed;
+	if (g_step == NULL_PTR)
+		return 0;
+	elapsed = Tick_millis() - g_stepStart;
+	return (elapsed < g_step->duration_ms) ? g_step->duration_ms - elapsed : 0;
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+ *
+ * Module: Sequence
+ *
+ * File Name: sequence.h
+ *
+ * Description: Header file for the table driven door and alarm sequences
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef SEQUENCE_SEQUENCE_H_
+#define SEQUENCE_SEQUENCE_H_
+
+#include "../std_types.h"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+/* what a step does to the outputs when it starts */
+typedef enum {
+	SEQUENCE_NO_ACTION,
+	SEQUENCE_OPEN_DOOR,
+	SEQUENCE_CLOSE_DOOR,
+	SEQUENCE_STOP_DOOR,
+	SEQUENCE_ALARM_ON,
+	SEQUENCE_ALARM_OFF
+} Sequence_Action;
+
+/*
+ * One step of a sequence:
+ * state: id of the step recorded in the trace when it starts and published
+ *        as the door phase while the step runs
+ * action: output command applied when the step starts
+ * duration_ms: the step lasts this long, a door move also ends as soon as the
+ *              door reaches its position, a duration of 0 ends the sequence
+ *              at the next Sequence_update after the step started
+ */
+typedef struct {
+	uint8 state;
+	Sequence_Action action;
+	uint16 duration_ms;
+} Sequence_StepType;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Start running a table of steps from its first step
+ * a running sequence is abandoned where it is and its door move is stopped
+ */
+void Sequence_start(const Sequence_StepType *steps);
+/*
+ * Description:
+ * Move the running sequence on when its step is over
+ * to be called from the main loop
+ */
+void Sequence_update(void);
+/*
+ * Description:
+ * Returns TRUE while a sequence is running
+ */
+uint8 Sequence_isRunning(void);
+/*
+ * Description:
+ * Returns the state of the running step or 0 when no sequence runs
+ */
+uint8 Sequence_getState(void);
+/*
+ * Description:
+ * Returns the milliseconds left of the running step or 0 when no sequence runs
+ * a door move may end earlier when the door reaches its position
+ */
+uint16 Sequence_getRemaining(void);
+
+#endif /* SEQUENCE_SEQUENCE_H_ */
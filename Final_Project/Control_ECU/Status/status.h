@@ -0,0 +1,134 @@
+/******************************************************************************
+ *
+ * Module: Status
+ *
+ * File Name: status.h
+ *
+ * Description: Header file for the status events published by the control ECU
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef STATUS_STATUS_H_
+#define STATUS_STATUS_H_
+
+#include "../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * The control ECU keeps the last value of every topic with a sequence number
+ * that counts the changes of the topic
+ * STATUS_SUBSCRIBE mask: send the topics of the mask whenever they change
+ * STATUS_SNAPSHOT mask: send the current value of every topic of the mask
+ * every value is sent as a frame: STATUS_START, the type "STATUS_EVENT for a
+ * change or STATUS_SNAPSHOT", the topic, the sequence number, the length, the
+ * data "little endian" and a checksum that makes the sum of the bytes from the
+ * type to the checksum 0
+ * STATUS_START is never sent inside a frame: a STATUS_START or STATUS_ESCAPE
+ * byte is sent as STATUS_ESCAPE followed by the byte xor STATUS_ESCAPE_XOR
+ * so a receiver that lost its place finds the next frame
+ * a subscriber that misses a sequence number or a frame asks for a snapshot
+ */
+#define STATUS_START 0x7E
+#define STATUS_ESCAPE 0x7D
+#define STATUS_ESCAPE_XOR 0x20
+#define STATUS_EVENT 'N'
+#define STATUS_SUBSCRIBE 'W'
+#define STATUS_SNAPSHOT 'Q'
+
+#define STATUS_MASK(topic) (1 << (topic))
+#define STATUS_ALL (STATUS_MASK(STATUS_TOPIC_COUNT) - 1)
+/* returned by Status_receive for a frame that didn't arrive in time or is corrupted */
+#define STATUS_NO_TOPIC 0xFF
+/* largest data of a topic */
+#define STATUS_DATA_SIZE 4
+
+/* maximum time to wait for each byte of a status frame */
+#define STATUS_TIMEOUT_MS 200
+
+/* door phases, the states of the control ECU sequence steps */
+#define STATUS_PHASE_IDLE 0
+#define STATUS_PHASE_OPENING 1
+#define STATUS_PHASE_OPEN 2
+#define STATUS_PHASE_CLOSING 3
+#define STATUS_PHASE_CLOSED 4
+#define STATUS_PHASE_ALARM 5
+#define STATUS_PHASE_ALARM_OFF 6
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+typedef enum {
+	STATUS_DOOR,     /* Status_DoorType */
+	STATUS_MOTOR,    /* Status_MotorType */
+	STATUS_LOCKOUT,  /* Status_LockoutType */
+	STATUS_EEPROM,   /* Status_EepromType */
+	STATUS_TOPIC_COUNT
+} Status_Topic;
+
+typedef struct {
+	uint8 phase;     /* STATUS_PHASE_IDLE when no sequence runs */
+	sint16 position; /* encoder counts, see Door/door.h */
+} Status_DoorType;
+
+typedef struct {
+	uint8 direction; /* DCMotorState */
+	uint8 speed;     /* duty cycle in percent */
+} Status_MotorType;
+
+typedef struct {
+	uint16 remaining_s; /* seconds left of the alarm, 0 when there is no lockout */
+} Status_LockoutType;
+
+typedef struct {
+	uint8 errors; /* failed EEPROM transfers since start up */
+} Status_EepromType;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Publisher: set the value of a topic, if it changed its sequence number is
+ * incremented and it is sent to the subscriber
+ */
+void Status_publish(uint8 topic, const void *data, uint8 length);
+/*
+ * Description:
+ * Publisher: answer STATUS_SUBSCRIBE or STATUS_SNAPSHOT, called after the
+ * command is received
+ */
+void Status_handleRequest(uint8 command);
+/*
+ * Description:
+ * Subscriber: ask the publisher to send the topics of the mask as they change
+ */
+void Status_subscribe(uint8 mask);
+/*
+ * Description:
+ * Subscriber: ask for the current value of the topics of the mask and wait for them
+ * returns FALSE if any of them didn't arrive
+ */
+uint8 Status_requestSnapshot(uint8 mask);
+/*
+ * Description:
+ * Subscriber: read the rest of a frame after its STATUS_START byte and keep
+ * its value, returns the topic or STATUS_NO_TOPIC
+ */
+uint8 Status_receive(void);
+/*
+ * Description:
+ * Copy the last value of a topic to data and return its length
+ * returns 0 if no value was received or published yet
+ */
+uint8 Status_get(uint8 topic, void *data, uint8 size);
+/*
+ * Description:
+ * Subscriber: returns TRUE if an event was missed since the last snapshot
+ */
+uint8 Status_isStale(void);
+
+#endif /* STATUS_STATUS_H_ */
@@ -12,6 +12,7 @@
 
 #include "twi.h"
 #include "../common_macros.h"
+#include "../Trace/trace.h"
 #include <avr/io.h>
 
 /*
@@ -66,6 +67,7 @@ void TWI_stop(void) {
 	 * Enable TWI Module TWEN=1
 	 */
 	TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+	TRACE_EVENT(TRACE_TWI_STOP, 0);
 }
 /*
  * Description:
@@ -0,0 +1,76 @@
+/******************************************************************************
+ *
+ * Module: Tick
+ *
+ * File Name: tick.c
+ *
+ * Description: Source file for the system millisecond tick
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "tick.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+static volatile uint32 g_ms = 0; /* milliseconds counted since Tick_init */
+
+/*
+ * Description:
+ * Timer1 compare match call back, called every 1 millisecond
+ */
+static void Tick_count(void) {
+	g_ms++;
+}
+
+/*
+ * Description:
+ * Start Timer1 to generate an interrupt every 1 millisecond
+ * global interrupts must be enabled by the application
+ */
+void Tick_init(void) {
+	/* the prescaler is fixed to keep the TICK_COUNTS_PER_MS resolution */
+	Timer1_ConfigType tickConfig = { 0, TICK_COMPARE_VALUE, TICK_PRESCALER,
+			CTC_MODE };
+	Timer1_setCallBack(Tick_count);
+	Timer1_init(&tickConfig);
+}
+/*
+ * Description:
+ * Returns the number of milliseconds since Tick_init
+ */
+uint32 Tick_millis(void) {
+	uint32 ms;
+	uint8 sreg = SREG;
+	/* 32-bit read is not atomic on AVR so block the tick interrupt while reading */
+	cli();
+	ms = g_ms;
+	SREG = sreg;
+	return ms;
+}
+/*
+ * Description:
+ * Returns the number of microseconds since Tick_init with the resolution
+ * of one timer count (8us at 8MHz), it wraps after 71.6 minutes so it is
+ * for measuring short intervals with (Tick_micros() - start)
+ */
+uint32 Tick_micros(void) {
+	uint32 ms;
+	uint16 count;
+	uint8 sreg = SREG;
+	cli();
+	ms = g_ms;
+	count = TCNT1;
+	/*
+	 * the counter may have cleared after interrupts were blocked, then the
+	 * compare flag is still pending and the millisecond isn't counted yet
+	 */
+	if ((TIFR & (1 << OCF1A)) && count < (TICK_COUNTS_PER_MS / 2)) {
+		ms++;
+	}
+	SREG = sreg;
+	/* constant condition, the compiler keeps only one of the conversions */
+	if ((1000UL % TICK_COUNTS_PER_MS) == 0)
+		return ms * 1000UL + (uint32) count * (1000UL / TICK_COUNTS_PER_MS);
+	return ms * 1000UL + ((uint32) count * 1000UL) / TICK_COUNTS_PER_MS;
+}
@@ -0,0 +1,56 @@
+/******************************************************************************
+ *
+ * Module: Tick
+ *
+ * File Name: tick.h
+ *
+ * Description: Header file for the system millisecond tick
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef TICK_TICK_H_
+#define TICK_TICK_H_
+
+#include "../std_types.h"
+#include "../Timer/timer.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Timer1 runs in compare mode with prescaler F_CPU/64 and the compare value
+ * Tick_init programs to get an interrupt every 1 ms
+ * Timer2 is left for the buzzer tones on this ECU
+ */
+#define TICK_PRESCALER F_CPU_64
+#define TICK_COMPARE_VALUE TIMER1_COMPARE_FOR_MS(1, TICK_PRESCALER)
+/* timer counts in one millisecond, one count is 8us at 8MHz */
+#define TICK_COUNTS_PER_MS ((uint16) TICK_COMPARE_VALUE + 1)
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Start Timer1 to generate an interrupt every 1 millisecond
+ * global interrupts must be enabled by the application
+ */
+void Tick_init(void);
+/*
+ * Description:
+ * Returns the number of milliseconds since Tick_init
+ * the counter wraps after 49.7 days so always compare differences:
+ * (Tick_millis() - start) >= period
+ */
+uint32 Tick_millis(void);
+/*
+ * Description:
+ * Returns the number of microseconds since Tick_init with the resolution
+ * of one timer count (8us at 8MHz), it wraps after 71.6 minutes so it is
+ * for measuring short intervals with (Tick_micros() - start)
+ */
+uint32 Tick_micros(void);
+
+#endif /* TICK_TICK_H_ */
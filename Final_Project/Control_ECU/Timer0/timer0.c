@@ -4,37 +4,105 @@
  *
  * File Name: timer0.c
  *
- * Description: Source file for the AVR Timer0 driver
+ * Description: Source file for the AVR Timer0 PWM driver
  *
  * Author: Mahmoud Khalafallah
  *
  *******************************************************************************/
 #include "timer0.h"
+#include "../common_macros.h"
 
 #include "avr/io.h"
+#include <avr/interrupt.h>
+
+static void (*volatile timer0CallBack)(void) = NULL_PTR; //Call Back Function for Timer 0
+
 /*
- * Description:
- * Generate a PWM signal with frequency 500Hz
- * Timer0 will be used with pre-scaler F_CPU/64
- * F_PWM=(F_CPU)/(256*N) = (8*10^6)/(256*64) = 490Hz
- * Duty Cycle can be changed by updating the value
- * in The Compare Register
+ * Percent to compare value: duty * 255 / 100 ~= (duty * 653) >> 8
+ * 100 * 653 = 65300 still fits in 16 bits and the result is within one
+ * count of the exact value, without pulling in a division routine
  */
-void PWM_Timer0_Start(uint8 duty_cycle) {
+#define TIMER0_DUTY_MULTIPLIER 653U
 
+/*
+ * Description:
+ * Configure Timer0 to generate a non inverted PWM signal on PB3/OC0
+ * the output starts at 0% duty cycle
+ */
+void PWM_Timer0_init(const Timer0_ConfigType *Config_Ptr) {
 	TCNT0 = 0; //Set Timer Initial value
 
-	OCR0 = (duty_cycle / 100.0) * 255; // Set Compare Value
+	OCR0 = 0; // Start with the output low
 
+	/* keep the pin low while OC0 is disconnected */
+	CLEAR_BIT(PORTB, PB3);
 	DDRB |= (1 << PB3); //set PB3/OC0 as output pin --> pin where the PWM signal is generated from MC.
 
 	/* Configure timer control register
-	 * 1. Fast PWM mode FOC0=0
-	 * 2. Fast PWM Mode WGM01=1 & WGM00=1
-	 * 3. Clear OC0 when match occurs (non inverted mode) COM00=0 & COM01=1
-	 * 4. clock = F_CPU/64 CS00=1 CS01=1 CS02=0
+	 * 1. PWM mode FOC0=0
+	 * 2. Fast PWM WGM01=1 & WGM00=1 or Phase correct PWM WGM01=0 & WGM00=1
+	 * 3. OC0 disconnected until a duty cycle is set COM00=0 & COM01=0
+	 * 4. clock = the requested prescaler CS02:0
 	 */
-	TCCR0 = (1 << WGM00) | (1 << WGM01) | (1 << COM01) | (1 << CS01)
-			| (1 << CS00);
+	switch (Config_Ptr->mode) {
+	case TIMER0_FAST_PWM:
+		TCCR0 = (1 << WGM00) | (1 << WGM01);
+		break;
+	case TIMER0_PHASE_CORRECT_PWM:
+		TCCR0 = (1 << WGM00);
+		break;
+	}
+	TCCR0 |= (Config_Ptr->prescaler & 0x07);
+}
+/*
+ * Description:
+ * Set the duty cycle in percent (values above 100 are taken as 100)
+ * 0% disconnects OC0 so the pin stays low without the one count
+ * spike fast PWM generates with OCR0 = 0
+ */
+void PWM_Timer0_setDuty(uint8 duty_cycle) {
+	if (duty_cycle == 0) {
+		/* OC0 disconnected -> the pin follows PORTB3 which is low */
+		CLEAR_BIT(TCCR0, COM01);
+		return;
+	}
+	if (duty_cycle > 100) {
+		duty_cycle = 100;
+	}
+	/* OCR0 is double buffered in PWM modes so the new duty starts with the next period */
+	OCR0 = ((uint16) duty_cycle * TIMER0_DUTY_MULTIPLIER) >> 8;
+	/* Clear OC0 when match occurs (non inverted mode) COM00=0 & COM01=1 */
+	SET_BIT(TCCR0, COM01);
+}
+/*
+ * Description:
+ * Stop the timer clock and force PB3/OC0 low
+ */
+void PWM_Timer0_stop(void) {
+	TCCR0 = 0;
+	CLEAR_BIT(PORTB, PB3);
+}
+/*
+ * Description:
+ * Call a function at the end of every PWM period from the overflow interrupt
+ * passing NULL_PTR disables the interrupt
+ */
+void PWM_Timer0_setCallBack(void (*a_ptr)(void)) {
+	timer0CallBack = a_ptr;
+	if (a_ptr != NULL_PTR) {
+		/* drop an overflow that is already pending so the first call is a full period away */
+		TIFR = (1 << TOV0);
+		SET_BIT(TIMSK, TOIE0);
+	} else {
+		CLEAR_BIT(TIMSK, TOIE0);
+	}
 }
 
+/*
+ * ISR for Timer 0 overflow at the end of each PWM period
+ */
+ISR(TIMER0_OVF_vect) {
+	if (timer0CallBack != NULL_PTR) {
+		timer0CallBack();
+	}
+}
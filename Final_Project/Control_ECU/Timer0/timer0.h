@@ -2,9 +2,9 @@
  *
  * Module: Timer0
  *
- * File Name: timer0.c
+ * File Name: timer0.h
  *
- * Description: Source file for the AVR timer0 driver
+ * Description: Header file for the AVR Timer0 PWM driver
  *
  * Author: Mahmoud Khalafallah
  *
@@ -15,14 +15,67 @@
 #define TIMER0_TIMER0_H_
 
 #include "../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * PWM frequency for a prescaler division N:
+ * Fast PWM          F_PWM = F_CPU / (256 * N)
+ * Phase correct PWM F_PWM = F_CPU / (510 * N)
+ * e.g. F_CPU = 8MHz, N = 64 -> 488Hz fast or 245Hz phase correct
+ */
+#define TIMER0_FAST_PWM_FREQUENCY(N) (F_CPU / (256UL * (N)))
+#define TIMER0_PHASE_CORRECT_PWM_FREQUENCY(N) (F_CPU / (510UL * (N)))
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+/* values match the clock select bits CS02:0 */
+typedef enum {
+	TIMER0_NO_CLOCK,
+	TIMER0_F_CPU_1,
+	TIMER0_F_CPU_8,
+	TIMER0_F_CPU_64,
+	TIMER0_F_CPU_256,
+	TIMER0_F_CPU_1024
+} Timer0_Prescaler;
+
+typedef enum {
+	TIMER0_FAST_PWM, TIMER0_PHASE_CORRECT_PWM
+} Timer0_Mode;
+
+typedef struct {
+	Timer0_Mode mode;
+	Timer0_Prescaler prescaler;
+} Timer0_ConfigType;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Configure Timer0 to generate a non inverted PWM signal on PB3/OC0
+ * the output starts at 0% duty cycle
+ */
+void PWM_Timer0_init(const Timer0_ConfigType *Config_Ptr);
+/*
+ * Description:
+ * Set the duty cycle in percent (values above 100 are taken as 100)
+ * 0% disconnects OC0 so the pin stays low without the one count
+ * spike fast PWM generates with OCR0 = 0
+ */
+void PWM_Timer0_setDuty(uint8 duty_cycle);
+/*
+ * Description:
+ * Stop the timer clock and force PB3/OC0 low
+ */
+void PWM_Timer0_stop(void);
 /*
  * Description:
- * Generate a PWM signal with frequency 500Hz
- * Timer0 will be used with pre-scaler F_CPU/8
- * F_PWM=(F_CPU)/(256*N) = (10^6)/(256*8) = 500Hz
- * Duty Cycle can be changed by updating the value
- * in The Compare Register
+ * Call a function at the end of every PWM period from the overflow interrupt
+ * passing NULL_PTR disables the interrupt
  */
-void PWM_Timer0_Start(uint8 duty_cycle);
+void PWM_Timer0_setCallBack(void (*a_ptr)(void));
 
 #endif /* TIMER0_TIMER0_H_ */
@@ -0,0 +1,71 @@
+/******************************************************************************
+ *
+ * Module: Trace
+ *
+ * File Name: trace.c
+ *
+ * Description: Source file for the timestamped event trace
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "trace.h"
+
+#if TRACE_ENABLE
+
+#include "../Tick/tick.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+static Trace_EntryType g_trace[TRACE_BUFFER_SIZE];
+static volatile uint8 g_traceHead = 0;  /* index of the next entry to write */
+static volatile uint8 g_traceCount = 0; /* number of valid entries */
+static volatile uint8 g_traceFrozen = FALSE;
+
+/*
+ * Description:
+ * Add an event to the trace ring overwriting the oldest one if it is full
+ */
+void Trace_record(uint8 id, uint8 data) {
+	uint8 sreg = SREG;
+	uint8 index;
+
+	/* block interrupts so an event recorded in an ISR can't take the same entry */
+	cli();
+	if (!g_traceFrozen) {
+		index = g_traceHead;
+		g_traceHead = (index + 1) & (TRACE_BUFFER_SIZE - 1);
+		if (g_traceCount < TRACE_BUFFER_SIZE)
+			g_traceCount++;
+		g_trace[index].time = (uint16) Tick_millis();
+		g_trace[index].id = id;
+		g_trace[index].data = data;
+	}
+	SREG = sreg;
+}
+/*
+ * Description:
+ * Stop recording so the ring can be read and return the number of entries in it
+ */
+uint8 Trace_freeze(void) {
+	g_traceFrozen = TRUE;
+	return g_traceCount;
+}
+/*
+ * Description:
+ * Read an entry of the frozen ring, index 0 is the oldest entry
+ */
+void Trace_getEntry(uint8 index, Trace_EntryType *entry) {
+	*entry = g_trace[(g_traceHead - g_traceCount + index)
+			& (TRACE_BUFFER_SIZE - 1)];
+}
+/*
+ * Description:
+ * Empty the ring and start recording again
+ */
+void Trace_clear(void) {
+	g_traceCount = 0;
+	g_traceFrozen = FALSE;
+}
+
+#endif /* TRACE_ENABLE */
@@ -0,0 +1,99 @@
+/******************************************************************************
+ *
+ * Module: Trace
+ *
+ * File Name: trace.h
+ *
+ * Description: Header file for the timestamped event trace
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef TRACE_TRACE_H_
+#define TRACE_TRACE_H_
+
+#include "../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* set to 0 to remove every trace event and the trace buffer from the image */
+#define TRACE_ENABLE 1
+
+/* number of entries kept in the trace ring, must be a power of two */
+#define TRACE_BUFFER_SIZE 32
+
+#if TRACE_ENABLE
+#define TRACE_EVENT(id, data) Trace_record((id), (data))
+#else
+#define TRACE_EVENT(id, data) ((void) 0)
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+/*
+ * Event ids shared by both ECUs, the data byte of each event is:
+ * UART_TIMEOUT: 0, UART_FRAME_IN/OUT: string length
+ * TWI_STOP: 0, EEPROM_*: number of bytes
+ * LCD_STRING_*: characters of a string "0 at the begin" or segments of a batch
+ * LCD_CLEAR: 0
+ * APP_COMMAND: command byte, APP_DOOR_PHASE: state of the sequence step entered
+ * APP_KEY: key
+ * APP_WAIT_BEGIN: expected byte, APP_WAIT_END: expected byte or 0 on timeout
+ * APP_SCREEN: screen id entered
+ * the host decoder in Tools/diag.py must be kept in the same order
+ */
+typedef enum {
+	TRACE_UART_TIMEOUT,
+	TRACE_UART_FRAME_IN,
+	TRACE_UART_FRAME_OUT,
+	TRACE_TWI_STOP,
+	TRACE_EEPROM_READ_BEGIN,
+	TRACE_EEPROM_READ_END,
+	TRACE_EEPROM_WRITE_BEGIN,
+	TRACE_EEPROM_WRITE_END,
+	TRACE_LCD_STRING_BEGIN,
+	TRACE_LCD_STRING_END,
+	TRACE_LCD_CLEAR,
+	TRACE_APP_COMMAND,
+	TRACE_APP_DOOR_PHASE,
+	TRACE_APP_KEY,
+	TRACE_APP_WAIT_BEGIN,
+	TRACE_APP_WAIT_END,
+	TRACE_APP_SCREEN
+} Trace_EventId;
+
+typedef struct {
+	uint16 time; /* low 16 bits of Tick_millis() when the event was recorded */
+	uint8 id;
+	uint8 data;
+} Trace_EntryType;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Add an event to the trace ring overwriting the oldest one if it is full
+ * it can be called from interrupts, use TRACE_EVENT so it is removed when tracing is disabled
+ */
+void Trace_record(uint8 id, uint8 data);
+/*
+ * Description:
+ * Stop recording so the ring can be read and return the number of entries in it
+ */
+uint8 Trace_freeze(void);
+/*
+ * Description:
+ * Read an entry of the frozen ring, index 0 is the oldest entry
+ */
+void Trace_getEntry(uint8 index, Trace_EntryType *entry);
+/*
+ * Description:
+ * Empty the ring and start recording again
+ */
+void Trace_clear(void);
+
+#endif /* TRACE_TRACE_H_ */
@@ -11,13 +11,19 @@
  *******************************************************************************/
 
 #include "UART/uart.h"
-#include "Timer/timer.h"
+#include "Tick/tick.h"
+#include "Diag/diag.h"
+#include "Trace/trace.h"
 #include "TWI/twi.h"
 #include "EEPROM/eeprom.h"
 #include <avr/io.h>
 #include <util/delay.h>
 #include "Buzzer/buzzer.h"
 #include "Motor/motor.h"
+#include "Door/door.h"
+#include "Sequence/sequence.h"
+#include "Power/power.h"
+#include "Status/status.h"
 
 /*******************************************************************************
  *                      		definitions			                           *
@@ -30,87 +36,176 @@
  * if it is not the first time the address will hold a value of 'F'
  */
 #define FIRSTTIMEFLAGADDRESS 0x0320
+/*
+ * maximum time to wait for each byte of a password from the HMI ECU
+ * if it expires the command is dropped and the HMI ECU retries it
+ */
+#define LINK_TIMEOUT_MS 200
+/* size of the password strings: 5 digits and the null terminator */
+#define PASSWORD_SIZE 6
+/* confirm result when the session missed digits, the HMI ECU sends the whole password with 'M' */
+#define SESSION_INVALID '?'
+/* the status topics are sampled this often so a moving door sends a few events a second */
+#define STATUS_PERIOD_MS 100
 
 /*******************************************************************************
  *                      		Global variables			                    *
  *******************************************************************************/
 /*
- * different timer configurations for different periods
- * 1. 7.5 seconds
- * 2. 3 seconds
+ * Door cycle after the right password:
+ * open for up to 15 seconds, hold 3 seconds and close for up to 15 seconds
+ * with position feedback the moves end as soon as the door gets there
+ * the HMI ECU follows the phases on the STATUS_DOOR topic
  */
+const Sequence_StepType g_doorSequence[] = {
+		{ STATUS_PHASE_OPENING, SEQUENCE_OPEN_DOOR, 15000 },
+		{ STATUS_PHASE_OPEN, SEQUENCE_STOP_DOOR, 3000 },
+		{ STATUS_PHASE_CLOSING, SEQUENCE_CLOSE_DOOR, 15000 },
+		{ STATUS_PHASE_CLOSED, SEQUENCE_STOP_DOOR, 0 } };
+/*
+ * Alarm after 3 wrong passwords:
+ * sound the alarm sweep for 45 seconds, the HMI ECU is released when the
+ * STATUS_DOOR topic goes back to STATUS_PHASE_IDLE
+ */
+const Sequence_StepType g_lockoutSequence[] = {
+		{ STATUS_PHASE_ALARM, SEQUENCE_ALARM_ON, 45000 },
+		{ STATUS_PHASE_ALARM_OFF, SEQUENCE_ALARM_OFF, 0 } };
 
-Timer1_ConfigType timerConfig_7_5_Seconds = { 0, 58590, F_CPU_1024, CTC_MODE };
-Timer1_ConfigType timerConfig_3_Seconds = { 0, 23436, F_CPU_1024, CTC_MODE };
+/*
+ * Verification session: the HMI ECU opens it with 'S' when it asks for the password
+ * the stored password is read from the EEPROM then, every digit is compared as
+ * it is typed so the confirm after Enter has nothing left to read or compare
+ */
+uint8 g_sessionPassword[PASSWORD_SIZE]; /* stored password read when the session opened */
+uint8 g_sessionLength;                  /* digits received in the session */
+uint8 g_sessionMatch;                   /* TRUE while every digit matched */
+uint8 g_sessionOpen = FALSE;
 
-uint8 g_tick = 0;/* a variable for number of interrupts for the timer */
+/* time the status topics were last sampled and the door phase then */
+uint32 g_statusTime = 0;
+uint8 g_statusPhase = STATUS_PHASE_IDLE;
 
 /*******************************************************************************
  *                              Functions Definitions                           *
  *******************************************************************************/
 /*
  * Description:
- * function for timer for closing the buzzer after one minute
- * will be set as call back function when the user enters a wrong password 3 times
+ * functions that checks the equality of two strings
+ * the terminators are compared too so a prefix of the password doesn't match
  */
-void wrongPassword() {
-	g_tick++;
-	if (g_tick == 6) {
-		Buzzer_off();
-		UART_sendData('D');
-		Timer1_deInit();
-		g_tick = 0;
+uint8 arePasswordsEqual(uint8 *firstPassword, uint8 *secondPassword) {
+	uint8 i = 0;
+	while (firstPassword[i] == secondPassword[i]) {
+		if (firstPassword[i] == '\0')
+			return TRUE;
+		i++;
 	}
+	return FALSE;
 }
 /*
  * Description:
- * function for timer for handling the logic after the user Enters the right password
- * will be set as call back function when the user enters the right password and wants to open the door
+ * read the stored password, the EEPROM holds it followed by '\0'
+ * a 5 digits password written before the terminator was stored is still read right
  */
-void openDoor() {
-	g_tick++;
-	/*
-	 * after 15 seconds:
-	 * Stop the motor and send 'U' for the HMI ECU to inform it that the door has been opened and will hold
-	 * and then set the timer to make an interrupt after 3 seconds
-	 */
-	if (g_tick == 2) {
-		DCMotor_rotate(STOP, 0);
-		UART_sendData('U');
-		Timer1_init(&timerConfig_3_Seconds);
-		/*
-		 * after 3 more seconds:
-		 * rotate the motor anti-clock wise and send 'H' for the HMI ECU to inform it that the door is closing
-		 * and then set the timer to make an interrupt after 7.5 seconds
-		 */
-	} else if (g_tick == 3) {
-		DCMotor_rotate(ANTI_CLOCK_WISE, MOTOR_FULL_SPEED);
-		UART_sendData('H');
-		Timer1_init(&timerConfig_7_5_Seconds);
-		/*
-		 * after 15 more seconds:
-		 * stop the motor and send 'L' for the HMI ECU to inform it that the door has been closed
-		 * and then stop the timer and reset the ticks variable
-		 */
-	} else if (g_tick == 5) {
-		DCMotor_rotate(STOP, 0);
-		UART_sendData('L');
-		Timer1_deInit();
-		g_tick = 0;
+void readStoredPassword(uint8 *password) {
+	EEPROM_readString(PASSSTARTADDRESS, password, PASSWORD_SIZE - 1);
+}
+/*
+ * Description:
+ * save a new password with its terminator so a shorter password
+ * doesn't keep the digits of the old one
+ */
+void savePassword(uint8 *password) {
+	uint8 length = 0;
+	while (password[length] != '\0')
+		length++;
+	EEPROM_writeSting(PASSSTARTADDRESS, password);
+	EEPROM_writeByte(PASSSTARTADDRESS + length, '\0');
+	_delay_ms(10);
+}
+/*
+ * Description:
+ * 'S': open a verification session, the HMI ECU doesn't wait for a reply
+ */
+void openSession(void) {
+	readStoredPassword(g_sessionPassword);
+	g_sessionLength = 0;
+	g_sessionMatch = TRUE;
+	g_sessionOpen = TRUE;
+}
+/*
+ * Description:
+ * 'K' index digit: compare a typed digit with the stored one
+ * a missing or repeated digit invalidates the session
+ */
+void sessionDigit(void) {
+	uint8 index, digit;
+	if (UART_receiveDataTimeout(&index, LINK_TIMEOUT_MS) != UART_OK
+			|| UART_receiveDataTimeout(&digit, LINK_TIMEOUT_MS) != UART_OK
+			|| !g_sessionOpen || index != g_sessionLength
+			|| g_sessionLength >= PASSWORD_SIZE - 1) {
+		g_sessionOpen = FALSE;
+		return;
 	}
+	if (digit != g_sessionPassword[g_sessionLength])
+		g_sessionMatch = FALSE;
+	g_sessionLength++;
+	/* key click for every digit the door side accepts */
+	Buzzer_play(BUZZER_CLICK);
 }
 /*
  * Description:
- * functions that checks the equality of two strings
+ * 'V' or 'O' length: return the result of the session
+ * 'A' if the digits match the whole stored password, 'B' if they don't and
+ * SESSION_INVALID if the session didn't get all the digits
+ * the session is closed after it
  */
-uint8 arePasswordsEqual(uint8 *firstPassword, uint8 *secondPassword) {
-	uint8 i = 0;
-	while (firstPassword[i] != '\0') {
-		if (firstPassword[i] != secondPassword[i])
-			return FALSE;
-		i++;
+uint8 confirmSession(void) {
+	uint8 length, result = SESSION_INVALID;
+	if (UART_receiveDataTimeout(&length, LINK_TIMEOUT_MS) != UART_OK)
+		length = 0xFF;
+	if (g_sessionOpen && length == g_sessionLength) {
+		result = (g_sessionMatch && g_sessionPassword[length] == '\0') ?
+				'A' : 'B';
 	}
-	return TRUE;
+	g_sessionOpen = FALSE;
+	return result;
+}
+/*
+ * Description:
+ * sample the door, motor, lockout and EEPROM status now
+ * the topics that changed are sent to the subscriber
+ */
+void sampleStatus(void) {
+	Status_DoorType door;
+	Status_MotorType motor;
+	Status_LockoutType lockout;
+	Status_EepromType eeprom;
+
+	g_statusTime = Tick_millis();
+	g_statusPhase = Sequence_getState();
+	door.phase = g_statusPhase;
+	door.position = Door_getPosition();
+	Status_publish(STATUS_DOOR, &door, sizeof(door));
+	motor.direction = DCMotor_getDirection();
+	motor.speed = DCMotor_getSpeed();
+	Status_publish(STATUS_MOTOR, &motor, sizeof(motor));
+	/* rounded up so the last second shows 1 until the alarm ends */
+	lockout.remaining_s = (door.phase == STATUS_PHASE_ALARM) ?
+			(Sequence_getRemaining() + 999) / 1000 : 0;
+	Status_publish(STATUS_LOCKOUT, &lockout, sizeof(lockout));
+	eeprom.errors = EEPROM_getErrors();
+	Status_publish(STATUS_EEPROM, &eeprom, sizeof(eeprom));
+}
+/*
+ * Description:
+ * sample the status every STATUS_PERIOD_MS and at once when the door phase
+ * changes so the HMI ECU changes its screen without waiting for the period
+ */
+void publishStatus(void) {
+	if (Sequence_getState() != g_statusPhase
+			|| (Tick_millis() - g_statusTime) >= STATUS_PERIOD_MS)
+		sampleStatus();
 }
 /*******************************************************************************
  *                      		 Main      			                           *
@@ -118,21 +213,25 @@ uint8 arePasswordsEqual(uint8 *firstPassword, uint8 *secondPassword) {
 int main(void) {
 	/*
 	 * Modules and devices Initializations
-	 * Timer, TWI, UART, Motor and Buzzer
+	 * Tick, TWI, UART, Motor and Buzzer
 	 */
 	/* Set TWI Speed to 400KHz and define controller address to 0x01 "when it is considered a slave" */
 	TWI_ConfigType twiConfig = { 0x01, RATE_400K };
 	TWI_init(&twiConfig);
 	/*Set UART frame to 8 bit data, no parity bit and single stop bit
-	 *Baud rate to 9600
+	 *Baud rate to the fastest rate within the error tolerance "250 Kbps at 8 MHz"
 	 */
-	UART_ConfigType uartConfig = { EIGHT_BITS, NO_PARITY, ONE_BIT, RATE_9600 };
+	UART_ConfigType uartConfig = { EIGHT_BITS, NO_PARITY, ONE_BIT, UART_LINK_BAUD };
 	UART_init(&uartConfig);
+	/* Start the millisecond tick used for the link timeouts and the sequence steps */
+	Tick_init();
 	/*
 	 * Motor and buzzer initialization by setting their pins to output and turning them off initially
+	 * the buzzer uses Timer2 for its tones so the tick runs on Timer1
 	 */
 	Buzzer_init();
 	DCMotor_init();
+	Door_init();
 	/*
 	 * Enable global interrupt
 	 */
@@ -140,58 +239,66 @@ int main(void) {
 	/*
 	 * Arrays "Strings" to hold the input passwords by the user and retrieve password from memory
 	 */
-	uint8 firstPassword[6], secondPassword2[6];
+	uint8 firstPassword[PASSWORD_SIZE], secondPassword2[PASSWORD_SIZE];
 	/* Flags for checking matching passwords and
 	 * check if it is the first time for the user to use the program
 	 * variable for holding UART received data
 	 */
 	uint8 matchingPasswordFlag = FALSE, firstTimeFlag, uartData;
-	/*
-	 * Holding until the HMI finishes initializations
-	 */
-	while (UART_receiveData() != 0xFF)
-		;
-	/*
-	 * read the address that holds the first time flag
-	 */
-	EEPROM_readByte(FIRSTTIMEFLAGADDRESS, &firstTimeFlag);
-	/* if it is the first time "the value stored in the address doesn't equal 'F'"
-	 * Store 'F' in this location
-	 */
-	if (firstTimeFlag != 'F') {
-		EEPROM_writeByte(FIRSTTIMEFLAGADDRESS, 'F');
-	}
-	/*
-	 * send 'Y' to the HMI ECU to inform that it will receive the first time flag value
-	 */
-	UART_sendData('Y');
-	UART_sendData(firstTimeFlag);
 
 	/*control code */
 	while (1) {
+		/* run the door or alarm sequence between the commands */
+		Sequence_update();
+		Buzzer_update();
+		publishStatus();
 		/*receiving values from HMI to get informed by what action is happening*/
-		uartData = UART_receiveData();
+		if (UART_receiveDataTimeout(&uartData, 0) != UART_OK) {
+			/* nothing to do until the next byte or tick */
+			Power_idle();
+			continue;
+		}
+		TRACE_EVENT(TRACE_APP_COMMAND, uartData);
 		switch (uartData) {
+		/*
+		 * if HMI sent 0xFF that means it finished its initializations or lost the link
+		 * send 'Y' to the HMI ECU to inform that it will receive the first time flag value
+		 * the flag equals 'F' once a password has been saved
+		 */
+		case 0xFF:
+			EEPROM_readByte(FIRSTTIMEFLAGADDRESS, &firstTimeFlag);
+			UART_sendData('Y');
+			UART_sendData(firstTimeFlag);
+			break;
 		/*
 		 * if HMI sent 'C' that means it will start sending passwords for set or reset and
 		 * will wait for the result
+		 * if any password doesn't arrive in time the command is dropped
 		 */
 		case 'C':
 			/*receiving first input password*/
-			UART_receiveString(firstPassword);
+			if (UART_receiveStringTimeout(firstPassword, PASSWORD_SIZE,
+			LINK_TIMEOUT_MS) != UART_OK)
+				break;
 			/*send 'C' to inform HMI to start sending the second password*/
 			UART_sendData('C');
 			/*receiving second input password*/
-			UART_receiveString(secondPassword2);
+			if (UART_receiveStringTimeout(secondPassword2, PASSWORD_SIZE,
+			LINK_TIMEOUT_MS) != UART_OK)
+				break;
 			/*checks two passwords equality*/
 			matchingPasswordFlag = arePasswordsEqual(firstPassword,
 					secondPassword2);
 			/*send 'C' to inform HMI that it will receive the result of the comparison*/
 			UART_sendData('C');
-			/*send 'A' if the two passwords are matched and 'B' it they aren't*/
+			/*
+			 * send 'A' if the two passwords are matched and 'B' it they aren't
+			 * mark that a password is saved so the HMI won't ask for a new one after a reset
+			 */
 			if (matchingPasswordFlag) {
 				UART_sendData('A');
-				EEPROM_writeSting(PASSSTARTADDRESS, firstPassword);
+				savePassword(firstPassword);
+				EEPROM_writeByte(FIRSTTIMEFLAGADDRESS, 'F');
 			} else
 				UART_sendData('B');
 			break;
@@ -202,10 +309,11 @@ int main(void) {
 			 */
 		case 'M':
 			/*receiving input password*/
-			UART_receiveString(firstPassword);
+			if (UART_receiveStringTimeout(firstPassword, PASSWORD_SIZE,
+			LINK_TIMEOUT_MS) != UART_OK)
+				break;
 			/*retrieve password stored in memory*/
-			EEPROM_readString(PASSSTARTADDRESS, secondPassword2, 5);
-			secondPassword2[5] = '\0';
+			readStoredPassword(secondPassword2);
 			/*check the input password*/
 			matchingPasswordFlag = arePasswordsEqual(firstPassword,
 					secondPassword2);
@@ -217,25 +325,73 @@ int main(void) {
 			} else
 				UART_sendData('B');
 			break;
+			/*
+			 * verification session: 'S' opens it when the HMI asks for the password,
+			 * 'K' sends every typed digit and 'V' confirms it after Enter
+			 * or 'O' confirms it and opens the door
+			 */
+		case 'S':
+			openSession();
+			break;
+		case 'K':
+			sessionDigit();
+			break;
+		case 'V':
+			uartData = confirmSession();
+			UART_sendData('Z');
+			UART_sendData(uartData);
+			break;
+			/*
+			 * 'O' length: verify and open in one request, the door starts moving
+			 * before the result is sent and its phases are reported as after 'T'
+			 * a running sequence isn't restarted
+			 */
+		case 'O':
+			uartData = confirmSession();
+			if (uartData == 'A' && !Sequence_isRunning())
+				Sequence_start(g_doorSequence);
+			UART_sendData('Z');
+			UART_sendData(uartData);
+			break;
 			/*
 			 * if HMI sent 'E' that means that user entered a wrong password 3 times
-			 * the control ECU starts the buzzer and initializes the timer
-			 * set the call back to the wrong password function
+			 * the control ECU starts the alarm sequence
 			 */
 		case 'E':
-			Buzzer_on();
-			Timer1_init(&timerConfig_7_5_Seconds);
-			Timer1_setCallBack(wrongPassword);
+			Sequence_start(g_lockoutSequence);
 			break;
 			/*
 			 * if HMI sent 'T' that means that user entered the right password
-			 * the control ECU starts the motor and initializes the timer
-			 * set the call back to the open door function
+			 * the control ECU starts the door sequence
+			 * it is ignored while a sequence runs, the HMI ECU sends it after a
+			 * lost reply to 'O' that may have started the door already
 			 */
 		case 'T':
-			DCMotor_rotate(CLOCK_WISE, MOTOR_FULL_SPEED);
-			Timer1_init(&timerConfig_7_5_Seconds);
-			Timer1_setCallBack(openDoor);
+			if (!Sequence_isRunning())
+				Sequence_start(g_doorSequence);
+			break;
+			/*
+			 * diagnostic request from the HMI ECU or a host tool on the link
+			 */
+		case DIAG_REQUEST:
+			Diag_handleRequest();
+			break;
+			/*
+			 * status subscription or snapshot from the HMI ECU or a host tool
+			 * the snapshot is sampled first so it doesn't answer with old values
+			 */
+		case STATUS_SUBSCRIBE:
+			Status_handleRequest(uartData);
+			break;
+		case STATUS_SNAPSHOT:
+			sampleStatus();
+			Status_handleRequest(uartData);
+			break;
+			/*
+			 * any other byte is a leftover of a dropped command so it is ignored
+			 */
+		default:
+			break;
 		}
 	}
 }
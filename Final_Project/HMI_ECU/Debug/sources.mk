@@ -19,10 +19,20 @@ C_DEPS :=
 
 # Every subdirectory with source files must be described here
 SUBDIRS := \
+Diag \
+Format \
 GPIO \
+Glyph \
 KEYPAD \
 LCD \
+MEM \
+Power \
+Status \
+Text \
+Tick \
 Timer \
+Trace \
 UART \
+UI \
 . \
 
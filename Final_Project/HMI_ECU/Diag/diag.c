@@ -0,0 +1,116 @@
+/******************************************************************************
+ *
+ * Module: Diag
+ *
+ * File Name: diag.c
+ *
+ * Description: Source file for the link diagnostic commands
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "diag.h"
+#include "../UART/uart.h"
+#include "../Trace/trace.h"
+#include "../MEM/mem.h"
+#include "../Power/power.h"
+
+/*
+ * Description:
+ * send a diagnostic block: header then the data bytes
+ */
+static void Diag_sendBlock(uint8 id, const uint8 *data, uint8 length) {
+	uint8 i;
+	UART_sendData(DIAG_REQUEST);
+	UART_sendData(id);
+	UART_sendData(length);
+	for (i = 0; i < length; i++) {
+		UART_sendData(data[i]);
+	}
+}
+#if TRACE_ENABLE
+/*
+ * Description:
+ * send the trace ring as a diagnostic block and clear it
+ * recording is stopped while the entries are sent
+ */
+static void Diag_sendTrace(void) {
+	uint8 count = Trace_freeze();
+	uint8 i;
+	Trace_EntryType entry;
+
+	UART_sendData(DIAG_REQUEST);
+	UART_sendData(DIAG_TRACE);
+	UART_sendData(count * sizeof(Trace_EntryType));
+	for (i = 0; i < count; i++) {
+		Trace_getEntry(i, &entry);
+		UART_sendData(entry.time & 0xFF);
+		UART_sendData(entry.time >> 8);
+		UART_sendData(entry.id);
+		UART_sendData(entry.data);
+	}
+	Trace_clear();
+}
+#endif
+/*
+ * Description:
+ * Answer a diagnostic request, called after DIAG_REQUEST is received
+ */
+void Diag_handleRequest(void) {
+	uint8 id;
+	UART_StatsType stats;
+	MEM_UsageType usage;
+	Power_StatsType power;
+
+	if (UART_receiveDataTimeout(&id, DIAG_TIMEOUT_MS) != UART_OK)
+		return;
+	switch (id) {
+	case DIAG_LINK_STATS:
+		UART_getStats(&stats);
+		Diag_sendBlock(id, (const uint8 *) &stats, sizeof(stats));
+		break;
+	case DIAG_MEMORY:
+		MEM_highWater(&usage);
+		Diag_sendBlock(id, (const uint8 *) &usage, sizeof(usage));
+		break;
+	case DIAG_POWER:
+		Power_getStats(&power);
+		Diag_sendBlock(id, (const uint8 *) &power, sizeof(power));
+		break;
+#if TRACE_ENABLE
+	case DIAG_TRACE:
+		Diag_sendTrace();
+		break;
+#endif
+	default:
+		Diag_sendBlock(id, NULL_PTR, 0);
+		break;
+	}
+}
+/*
+ * Description:
+ * Ask the other ECU for a diagnostic block and copy it to data
+ * returns the length of the block or 0 if there is no valid reply
+ */
+uint8 Diag_request(uint8 id, uint8 *data, uint8 size) {
+	uint8 byte, length, i;
+
+	UART_flush();
+	UART_sendData(DIAG_REQUEST);
+	UART_sendData(id);
+	/* skip anything received before the reply header */
+	do {
+		if (UART_receiveDataTimeout(&byte, DIAG_TIMEOUT_MS) != UART_OK)
+			return 0;
+	} while (byte != DIAG_REQUEST);
+	if (UART_receiveDataTimeout(&byte, DIAG_TIMEOUT_MS) != UART_OK || byte != id)
+		return 0;
+	if (UART_receiveDataTimeout(&length, DIAG_TIMEOUT_MS) != UART_OK
+			|| length > size)
+		return 0;
+	for (i = 0; i < length; i++) {
+		if (UART_receiveDataTimeout(&data[i], DIAG_TIMEOUT_MS) != UART_OK)
+			return 0;
+	}
+	return length;
+}
@@ -0,0 +1,266 @@
+/******************************************************************************
+ *
+ * Module: Format
+ *
+ * File Name: format.c
+ *
+ * Description: Source file for the integer and fixed point to text conversion
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "format.h"
+#include <avr/pgmspace.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* flags of a conversion */
+#define FORMAT_LEFT 0x01  /* pad on the right */
+#define FORMAT_ZERO 0x02  /* pad with zeros */
+#define FORMAT_LONG 0x04  /* the argument is 32-bit */
+
+/*******************************************************************************
+ *                      		Global variables			                    *
+ *******************************************************************************/
+/* powers of ten of the digits of a 32-bit number from the highest */
+static const uint32 g_powersOfTen[] PROGMEM = { 1000000000UL, 100000000UL,
+		10000000UL, 1000000UL, 100000UL, 10000UL, 1000UL, 100UL, 10UL };
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Write num in decimal to buffer terminated by '\0' and return the number of characters
+ * every digit takes at most 9 subtractions instead of a 32-bit division,
+ * the leading zeros are skipped
+ */
+uint8 Format_uint32(uint8 *buffer, uint32 num) {
+	uint8 i, digit, length = 0;
+	uint32 power;
+	if (num <= 0xFFFF)
+		return Format_uint16(buffer, (uint16) num);
+	for (i = 0; i < sizeof(g_powersOfTen) / sizeof(g_powersOfTen[0]); i++) {
+		power = pgm_read_dword(&g_powersOfTen[i]);
+		digit = '0';
+		while (num >= power) {
+			num -= power;
+			digit++;
+		}
+		if (digit != '0' || length != 0)
+			buffer[length++] = digit;
+	}
+	buffer[length++] = '0' + (uint8) num;
+	buffer[length] = '\0';
+	return length;
+}
+/*
+ * Description:
+ * Same as Format_uint32 for 16-bit numbers
+ * num / 10 = (num * 0xCCCD) >> 19 for every 16-bit num so no division is used,
+ * the digits are found from the lowest and written in reverse
+ */
+uint8 Format_uint16(uint8 *buffer, uint16 num) {
+	uint8 digits[5], count = 0, length = 0;
+	uint16 quotient;
+	do {
+		quotient = (uint16) (((uint32) num * 0xCCCDUL) >> 19);
+		digits[count++] = '0' + (uint8) (num - quotient * 10);
+		num = quotient;
+	} while (num != 0);
+	while (count != 0) {
+		buffer[length++] = digits[--count];
+	}
+	buffer[length] = '\0';
+	return length;
+}
+/*
+ * Description:
+ * Write num in decimal with a '-' if it is negative
+ */
+uint8 Format_sint32(uint8 *buffer, sint32 num) {
+	if (num < 0) {
+		buffer[0] = '-';
+		/* the unsigned negation is right for the most negative number too */
+		return Format_uint32(buffer + 1, -(uint32) num) + 1;
+	}
+	return Format_uint32(buffer, (uint32) num);
+}
+/*
+ * Description:
+ * Write a fixed point number, value is the number multiplied by 10^decimals
+ * the digits are written then the point is inserted before the last decimals
+ * with zeros added in front of a number smaller than one
+ */
+uint8 Format_fixed(uint8 *buffer, sint32 value, uint8 decimals) {
+	uint8 length, start = 0, i, shift;
+	if (decimals > FORMAT_MAX_DECIMALS)
+		decimals = FORMAT_MAX_DECIMALS;
+	if (value < 0) {
+		buffer[start++] = '-';
+	}
+	length = Format_uint32(buffer + start,
+			(value < 0) ? -(uint32) value : (uint32) value);
+	if (decimals == 0)
+		return start + length;
+	/* at least one digit before the point */
+	if (length <= decimals) {
+		shift = decimals + 1 - length;
+		for (i = length + 1; i != 0; i--) {
+			buffer[start + i - 1 + shift] = buffer[start + i - 1];
+		}
+		for (i = 0; i < shift; i++) {
+			buffer[start + i] = '0';
+		}
+		length += shift;
+	}
+	/* move the decimals and the '\0' one place to make room for the point */
+	for (i = 0; i <= decimals; i++) {
+		buffer[start + length + 1 - i] = buffer[start + length - i];
+	}
+	buffer[start + length - decimals] = '.';
+	return start + length + 1;
+}
+/*
+ * Description:
+ * Write num in hexadecimal without leading zeros, upper selects "A-F"
+ */
+uint8 Format_hex(uint8 *buffer, uint32 num, uint8 upper) {
+	uint8 shift = 28, nibble, length = 0;
+	for (;;) {
+		nibble = (uint8) (num >> shift) & 0x0F;
+		if (nibble != 0 || length != 0 || shift == 0) {
+			if (nibble < 10)
+				buffer[length++] = '0' + nibble;
+			else
+				buffer[length++] = (upper ? 'A' : 'a') + nibble - 10;
+		}
+		if (shift == 0)
+			break;
+		shift -= 4;
+	}
+	buffer[length] = '\0';
+	return length;
+}
+/*
+ * Description:
+ * Send the formatted text to the sink and return the number of characters
+ */
+uint16 Format_print(Format_PutType put, const char *format, ...) {
+	uint16 count;
+	va_list args;
+	va_start(args, format);
+	count = Format_vprint(put, format, args);
+	va_end(args);
+	return count;
+}
+/*
+ * Description:
+ * Same as Format_print with the arguments in a va_list
+ * every number is converted in a buffer on the stack, there is no float
+ * or 64-bit support so it stays a small fraction of vfprintf
+ */
+uint16 Format_vprint(Format_PutType put, const char *format, va_list args) {
+	uint8 buffer[FORMAT_BUFFER_SIZE];
+	const uint8 *text;
+	uint8 character, flags, width, decimals, length, pad, fromFlash;
+	uint16 count = 0;
+	uint32 value;
+	while ((character = pgm_read_byte(format++)) != '\0') {
+		if (character != '%') {
+			put(character);
+			count++;
+			continue;
+		}
+		flags = 0;
+		width = 0;
+		decimals = 0;
+		character = pgm_read_byte(format++);
+		if (character == '-') {
+			flags |= FORMAT_LEFT;
+			character = pgm_read_byte(format++);
+		}
+		if (character == '0') {
+			flags |= FORMAT_ZERO;
+			character = pgm_read_byte(format++);
+		}
+		while (character >= '0' && character <= '9') {
+			width = width * 10 + (character - '0');
+			character = pgm_read_byte(format++);
+		}
+		if (character == '.') {
+			character = pgm_read_byte(format++);
+			while (character >= '0' && character <= '9') {
+				decimals = decimals * 10 + (character - '0');
+				character = pgm_read_byte(format++);
+			}
+		}
+		if (character == 'l') {
+			flags |= FORMAT_LONG;
+			character = pgm_read_byte(format++);
+		}
+		text = buffer;
+		fromFlash = FALSE;
+		switch (character) {
+		case 'd':
+			value = (flags & FORMAT_LONG) ?
+					(uint32) va_arg(args, sint32) : (uint32) (sint32) va_arg(args, int);
+			length = Format_fixed(buffer, (sint32) value, decimals);
+			break;
+		case 'u':
+		case 'x':
+		case 'X':
+			value = (flags & FORMAT_LONG) ?
+					va_arg(args, uint32) : (uint32) va_arg(args, unsigned int);
+			length = (character == 'u') ?
+					Format_uint32(buffer, value) :
+					Format_hex(buffer, value, character == 'X');
+			break;
+		case 'c':
+			buffer[0] = (uint8) va_arg(args, int);
+			length = 1;
+			break;
+		case 's':
+			text = va_arg(args, const uint8 *);
+			length = strlen((const char *) text);
+			break;
+		case 'S':
+			text = va_arg(args, const uint8 *);
+			length = strlen_P((const char *) text);
+			fromFlash = TRUE;
+			break;
+		case '\0':
+			/* the format ended inside a conversion */
+			return count;
+		default:
+			/* "%%" and unknown types are printed as they are */
+			buffer[0] = character;
+			length = 1;
+			break;
+		}
+		pad = (width > length) ? width - length : 0;
+		count += length + pad;
+		if (!(flags & FORMAT_LEFT)) {
+			/* the sign comes before the zeros */
+			if ((flags & FORMAT_ZERO) && text == buffer && length != 0
+					&& text[0] == '-') {
+				put('-');
+				text++;
+				length--;
+			}
+			for (; pad != 0; pad--) {
+				put((flags & FORMAT_ZERO) ? '0' : ' ');
+			}
+		}
+		for (; length != 0; length--) {
+			put(fromFlash ? pgm_read_byte(text) : *text);
+			text++;
+		}
+		for (; pad != 0; pad--) {
+			put(' ');
+		}
+	}
+	return count;
+}
@@ -0,0 +1,80 @@
+/******************************************************************************
+ *
+ * Module: Format
+ *
+ * File Name: format.h
+ *
+ * Description: Header file for the integer and fixed point to text conversion
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef FORMAT_FORMAT_H_
+#define FORMAT_FORMAT_H_
+
+#include "../std_types.h"
+#include <stdarg.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* buffer size that holds any 32-bit number: sign, 10 digits, point and '\0' */
+#define FORMAT_BUFFER_SIZE 13
+/* maximum number of digits after the point of a fixed point number */
+#define FORMAT_MAX_DECIMALS 9
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+/* a sink takes the formatted characters one by one */
+typedef void (*Format_PutType)(uint8 character);
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Write num in decimal to buffer terminated by '\0' and return the number of characters
+ * no division is used: every digit is found by subtracting its power of ten
+ */
+uint8 Format_uint32(uint8 *buffer, uint32 num);
+/*
+ * Description:
+ * Same as Format_uint32 for 16-bit numbers, a division by 10 is a multiplication
+ * by its 16-bit reciprocal
+ */
+uint8 Format_uint16(uint8 *buffer, uint16 num);
+/*
+ * Description:
+ * Write num in decimal with a '-' if it is negative
+ */
+uint8 Format_sint32(uint8 *buffer, sint32 num);
+/*
+ * Description:
+ * Write a fixed point number, value is the number multiplied by 10^decimals
+ * Format_fixed(buffer, -1205, 2) writes "-12.05"
+ */
+uint8 Format_fixed(uint8 *buffer, sint32 value, uint8 decimals);
+/*
+ * Description:
+ * Write num in hexadecimal without leading zeros, upper selects "A-F"
+ */
+uint8 Format_hex(uint8 *buffer, uint32 num, uint8 upper);
+/*
+ * Description:
+ * Send the formatted text to the sink and return the number of characters
+ * format is in the flash "PSTR", a conversion is %[-][0][width][.decimals][l]type:
+ * d signed, u unsigned, x and X hexadecimal, c character, s RAM string,
+ * S flash string and %% for '%', l takes a 32-bit number instead of an int
+ * .decimals with d prints a fixed point number "value / 10^decimals"
+ * '-' pads on the right and '0' pads numbers with zeros instead of spaces
+ */
+uint16 Format_print(Format_PutType put, const char *format, ...);
+/*
+ * Description:
+ * Same as Format_print with the arguments in a va_list
+ */
+uint16 Format_vprint(Format_PutType put, const char *format, va_list args);
+
+#endif /* FORMAT_FORMAT_H_ */
@@ -0,0 +1,99 @@
+/******************************************************************************
+ *
+ * Module: Glyph
+ *
+ * File Name: glyph.c
+ *
+ * Description: Source file for the LCD custom character cache
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "glyph.h"
+#include "../LCD/lcd.h"
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                      		Global variables			                    *
+ *******************************************************************************/
+/* 5x8 bitmaps from the top row, in the same order as Glyph_Id */
+static const uint8 g_bitmaps[GLYPH_COUNT][8] PROGMEM = {
+	/* GLYPH_LOCKED */
+	{ 0b01110, 0b10001, 0b10001, 0b11111, 0b11011, 0b11011, 0b11111, 0b00000 },
+	/* GLYPH_UNLOCKED */
+	{ 0b01110, 0b10000, 0b10000, 0b11111, 0b11011, 0b11011, 0b11111, 0b00000 },
+	/* GLYPH_KEY */
+	{ 0b01110, 0b10001, 0b01110, 0b00100, 0b00100, 0b00110, 0b00100, 0b00110 },
+	/* GLYPH_BELL */
+	{ 0b00100, 0b01110, 0b01110, 0b01110, 0b11111, 0b00000, 0b00100, 0b00000 },
+	/* GLYPH_LINK_LOST */
+	{ 0b00000, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b00000, 0b00000 }
+};
+
+static uint8 g_slotGlyph[GLYPH_SLOTS] = { GLYPH_NONE, GLYPH_NONE, GLYPH_NONE,
+		GLYPH_NONE, GLYPH_NONE, GLYPH_NONE, GLYPH_NONE, GLYPH_NONE };
+static uint8 g_slotUsers[GLYPH_SLOTS];   /* number of Glyph_acquire not released */
+static uint16 g_slotUsed[GLYPH_SLOTS];   /* g_useClock when the slot was last acquired */
+static uint16 g_useClock = 0;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Returns the slot holding a glyph or GLYPH_SLOTS if it isn't loaded
+ */
+static uint8 Glyph_find(uint8 id) {
+	uint8 slot;
+	for (slot = 0; slot < GLYPH_SLOTS; slot++) {
+		if (g_slotGlyph[slot] == id)
+			break;
+	}
+	return slot;
+}
+/*
+ * Description:
+ * Load a glyph if it isn't in the CGRAM and return its character
+ * an empty slot is taken first, then the free slot used least recently
+ */
+uint8 Glyph_acquire(uint8 id) {
+	uint8 slot, victim = GLYPH_SLOTS;
+	if (id >= GLYPH_COUNT)
+		return GLYPH_MISSING;
+	slot = Glyph_find(id);
+	if (slot == GLYPH_SLOTS) {
+		for (slot = 0; slot < GLYPH_SLOTS; slot++) {
+			if (g_slotUsers[slot] != 0)
+				continue;
+			if (g_slotGlyph[slot] == GLYPH_NONE) {
+				victim = slot;
+				break;
+			}
+			/* the age is right across the clock wrap */
+			if (victim == GLYPH_SLOTS
+					|| (uint16) (g_useClock - g_slotUsed[slot])
+							> (uint16) (g_useClock - g_slotUsed[victim]))
+				victim = slot;
+		}
+		if (victim == GLYPH_SLOTS)
+			return GLYPH_MISSING;
+		slot = victim;
+		LCD_defineGlyph(slot, g_bitmaps[id]);
+		g_slotGlyph[slot] = id;
+	}
+	g_slotUsers[slot]++;
+	g_slotUsed[slot] = ++g_useClock;
+	return GLYPH_FIRST_CODE + slot;
+}
+/*
+ * Description:
+ * Release a glyph, it stays in the CGRAM until its slot is needed
+ */
+void Glyph_release(uint8 id) {
+	uint8 slot;
+	if (id >= GLYPH_COUNT)
+		return;
+	slot = Glyph_find(id);
+	if (slot != GLYPH_SLOTS && g_slotUsers[slot] != 0)
+		g_slotUsers[slot]--;
+}
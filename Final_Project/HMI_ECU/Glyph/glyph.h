@@ -0,0 +1,64 @@
+/******************************************************************************
+ *
+ * Module: Glyph
+ *
+ * File Name: glyph.h
+ *
+ * Description: Header file for the LCD custom character cache
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef GLYPH_GLYPH_H_
+#define GLYPH_GLYPH_H_
+
+#include "../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* number of CGRAM slots of the HD44780 */
+#define GLYPH_SLOTS 8
+/*
+ * the characters 8-15 show the CGRAM slots like 0-7 do, they are used
+ * so a glyph is never '\0' in a string
+ */
+#define GLYPH_FIRST_CODE 8
+/* no glyph */
+#define GLYPH_NONE 0xFF
+/* shown when all the slots are used by other glyphs */
+#define GLYPH_MISSING '?'
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+/* the bitmaps in glyph.c are in the same order */
+typedef enum {
+	GLYPH_LOCKED,
+	GLYPH_UNLOCKED,
+	GLYPH_KEY,
+	GLYPH_BELL,
+	GLYPH_LINK_LOST,
+	GLYPH_COUNT
+} Glyph_Id;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Load a glyph if it isn't in the CGRAM and return its character
+ * a slot that no one uses is replaced, the least recently used first
+ * returns GLYPH_MISSING if every slot is used
+ * every call must be matched by Glyph_release when the glyph isn't shown anymore
+ * the LCD is left addressing the CGRAM if a glyph is loaded
+ */
+uint8 Glyph_acquire(uint8 id);
+/*
+ * Description:
+ * Release a glyph, it stays in the CGRAM until its slot is needed
+ */
+void Glyph_release(uint8 id);
+
+#endif /* GLYPH_GLYPH_H_ */
@@ -11,7 +11,10 @@
  *******************************************************************************/
 #include "keypad.h"
 #include "../GPIO/gpio.h"
-#include <util/delay.h>
+#include "../Tick/tick.h"
+#include "../Power/power.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
 
 /*******************************************************************************
  *                      Functions Prototypes(Private)                          *
@@ -35,67 +38,176 @@ static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number);
 
 #endif /* STANDARD_KEYPAD */
 
+static uint8 g_lastScan = KEYPAD_NO_KEY;     /* key read by the last scan */
+static uint8 g_reportedKey = KEYPAD_NO_KEY;  /* key buffered and not released yet */
+static uint8 g_scanRow;                      /* row driven low now */
+static uint8 g_scanKey;                      /* key found by the scan in progress */
+/* the scan is stopped while the rows are driven low for the power down */
+static volatile uint8 g_scanEnabled = FALSE;
+/*
+ * ring buffer of the pressed keys, the tick interrupt writes the head and
+ * KEYPAD_readKey moves the tail
+ */
+static volatile uint8 g_keyBuffer[KEYPAD_BUFFER_SIZE];
+static volatile uint8 g_keyHead = 0, g_keyTail = 0;
+static volatile uint16 g_droppedKeys = 0;
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
 
-uint8 KEYPAD_getPressedKey(void) {
-	uint8 col, row;
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID,
-			PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID + 1,
-			PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID + 2,
-			PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID + 3,
-			PIN_INPUT);
-
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID,
-			PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID + 1,
-			PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID + 2,
-			PIN_INPUT);
-#if(KEYPAD_NUM_COLS == 4)
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID + 3,
-			PIN_INPUT);
-#endif
-	while (1) {
-		for (row = 0; row < KEYPAD_NUM_ROWS; row++) {
-
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,
-			KEYPAD_FIRST_ROW_PIN_ID + row, PIN_OUTPUT);
-			GPIO_writePin(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID + row,
-			KEYPAD_BUTTON_PRESSED);
-			for (col = 0; col < KEYPAD_NUM_COLS; col++) {
-				if (GPIO_readPin(KEYPAD_COL_PORT_ID,
-				KEYPAD_FIRST_COL_PIN_ID + col) == KEYPAD_BUTTON_PRESSED) {
-					while ((GPIO_readPin(KEYPAD_COL_PORT_ID,
-					KEYPAD_FIRST_COL_PIN_ID + col) == KEYPAD_BUTTON_PRESSED))
-						;
-#if(KEYPAD_NUM_COLS == 3)
-	#ifdef STANDARD_KETPAD
-					return ((row*KEYPAD_NUM_COLS)+col+1);
-											#else
-					return KEYPAD_4x3_adjustKeyNumber(
-							(row * KEYPAD_NUM_COLS) + col + 1);
-	#endif
-	#elif (KEYPAD_NUM_COLS == 4)
+/*
+ * Description :
+ * Map the switch number to the key value of the keypad shape
+ */
+static uint8 KEYPAD_adjustKeyNumber(uint8 button_number) {
 #ifdef STANDARD_KEYPAD
-					return ((row * KEYPAD_NUM_COLS) + col + 1);
-	#else
-					return KEYPAD_4x4_adjustKeyNumber(
-							(row * KEYPAD_NUM_COLS) + col + 1);
-#endif
+	return button_number;
+#elif (KEYPAD_NUM_COLS == 3)
+	return KEYPAD_4x3_adjustKeyNumber(button_number);
+#elif (KEYPAD_NUM_COLS == 4)
+	return KEYPAD_4x4_adjustKeyNumber(button_number);
 #endif
+}
+/*
+ * Description :
+ * Start a new scan from the first row
+ */
+static void KEYPAD_startScan(void) {
+	g_scanRow = 0;
+	g_scanKey = KEYPAD_NO_KEY;
+	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID,
+			PIN_OUTPUT);
+	GPIO_writePin(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID,
+			KEYPAD_BUTTON_PRESSED);
+}
+/*
+ * Description :
+ * Buffer the key of a finished scan when it reads the same in two scans,
+ * it is buffered once until it is released
+ */
+static void KEYPAD_scanDone(uint8 key) {
+	uint8 next;
+	if (key == g_lastScan && key != g_reportedKey) {
+		g_reportedKey = key;
+		if (key != KEYPAD_NO_KEY) {
+			next = (g_keyHead + 1) & (KEYPAD_BUFFER_SIZE - 1);
+			if (next != g_keyTail) {
+				g_keyBuffer[g_keyHead] = key;
+				g_keyHead = next;
+			} else {
+				g_droppedKeys++;
+			}
+		}
+	}
+	g_lastScan = key;
+}
+/*
+ * Description :
+ * Power down until a key in the first two columns is pressed
+ * all the rows are driven low so the key pulls INT0 or INT1 low
+ */
+void KEYPAD_powerDown(void) {
+	uint8 row, scanEnabled = g_scanEnabled;
+	/* the tick interrupt would change the rows, the scan starts over after waking up */
+	g_scanEnabled = FALSE;
+	for (row = 0; row < KEYPAD_NUM_ROWS; row++) {
+		GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID + row,
+				PIN_OUTPUT);
+		GPIO_writePin(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID + row,
+				KEYPAD_BUTTON_PRESSED);
+	}
+	/* low level interrupts are the only ones that wake up from power down */
+	MCUCR &= ~((1 << ISC11) | (1 << ISC10) | (1 << ISC01) | (1 << ISC00));
+	GICR |= (1 << INT0) | (1 << INT1);
+	Power_down();
+	for (row = 0; row < KEYPAD_NUM_ROWS; row++) {
+		GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID + row,
+				PIN_INPUT);
+	}
+	if (scanEnabled) {
+		KEYPAD_startScan();
+		g_scanEnabled = TRUE;
+	}
+}
+
+/*
+ * ISRs for the wake up keys, the level interrupt would fire again as long as
+ * the key is held so it is disabled, the scan reads the key after that
+ */
+ISR(INT0_vect) {
+	GICR &= ~((1 << INT0) | (1 << INT1));
+}
+ISR(INT1_vect) {
+	GICR &= ~((1 << INT0) | (1 << INT1));
+}
 
-				}
+/*
+ * Description :
+ * Tick call back, the row driven at the previous tick has settled so its
+ * columns are read then the next row is driven
+ * the rows of PORTB are left as inputs with their output bits low so the
+ * LCD control pins of the same port written from the main loop aren't disturbed
+ */
+static void KEYPAD_tick(void) {
+	uint8 col;
+	if (!g_scanEnabled)
+		return;
+	if (g_scanKey == KEYPAD_NO_KEY) {
+		for (col = 0; col < KEYPAD_NUM_COLS; col++) {
+			if (GPIO_readPin(KEYPAD_COL_PORT_ID,
+					KEYPAD_FIRST_COL_PIN_ID + col) == KEYPAD_BUTTON_PRESSED) {
+				g_scanKey = KEYPAD_adjustKeyNumber(
+						(g_scanRow * KEYPAD_NUM_COLS) + col + 1);
+				break;
 			}
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,
-			KEYPAD_FIRST_ROW_PIN_ID + row, PIN_INPUT);
-			_delay_ms(5);
 		}
 	}
+	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,
+			KEYPAD_FIRST_ROW_PIN_ID + g_scanRow, PIN_INPUT);
+	if (++g_scanRow == KEYPAD_NUM_ROWS) {
+		KEYPAD_scanDone(g_scanKey);
+		KEYPAD_startScan();
+	} else {
+		GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,
+				KEYPAD_FIRST_ROW_PIN_ID + g_scanRow, PIN_OUTPUT);
+		GPIO_writePin(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID + g_scanRow,
+				KEYPAD_BUTTON_PRESSED);
+	}
+}
+/*
+ * Description :
+ * Start scanning the keypad from the tick interrupt
+ */
+void KEYPAD_init(void) {
+	KEYPAD_startScan();
+	g_scanEnabled = TRUE;
+	Tick_setCallBack(KEYPAD_tick);
+}
+/*
+ * Description :
+ * Take the oldest buffered key, returns KEYPAD_NO_KEY if there is none
+ * only the tail is written here so no interrupt blocking is needed
+ */
+uint8 KEYPAD_readKey(void) {
+	uint8 key;
+	if (g_keyHead == g_keyTail)
+		return KEYPAD_NO_KEY;
+	key = g_keyBuffer[g_keyTail];
+	g_keyTail = (g_keyTail + 1) & (KEYPAD_BUFFER_SIZE - 1);
+	return key;
+}
+/*
+ * Description :
+ * Returns the number of keys dropped because the buffer was full
+ */
+uint16 KEYPAD_getDroppedKeys(void) {
+	uint16 dropped;
+	uint8 sreg = SREG;
+	cli();
+	dropped = g_droppedKeys;
+	SREG = sreg;
+	return dropped;
 }
 
 #ifndef STANDARD_KEYPAD
@@ -30,6 +30,26 @@
 #define KEYPAD_COL_PORT_ID                PORTD_ID
 #define KEYPAD_FIRST_COL_PIN_ID           PIN2_ID
 
+/*
+ * after this long without a key the ECU powers down until a key in the first
+ * two columns is pressed, they are on INT0/PD2 and INT1/PD3
+ * the link can't wake the ECU from power down
+ */
+#define KEYPAD_POWER_DOWN_MS              30000
+/*
+ * the tick interrupt reads one row every millisecond so the interrupt stays
+ * short, the whole keypad is scanned every KEYPAD_SCAN_MS, a key must be read
+ * the same in two scans to count so it is debounced for one scan period
+ */
+#define KEYPAD_SCAN_MS                    KEYPAD_NUM_ROWS
+/*
+ * keys pressed and not read yet, they are kept while the application waits
+ * for the link, a key pressed when it is full is dropped "power of 2"
+ */
+#define KEYPAD_BUFFER_SIZE                8
+/* returned by KEYPAD_readKey when no key is buffered, 0 is the digit 0 */
+#define KEYPAD_NO_KEY                     0xFF
+
 /* Keypad button logic configurations */
 #define KEYPAD_BUTTON_PRESSED            LOGIC_LOW
 #define KEYPAD_BUTTON_RELEASED           LOGIC_HIGH
@@ -40,8 +60,24 @@
 
 /*
  * Description :
- * Get the Keypad pressed button
+ * Start scanning the keypad from the tick interrupt, the pressed keys are
+ * buffered until KEYPAD_readKey takes them, Tick_init must be called first
+ */
+void KEYPAD_init(void);
+/*
+ * Description :
+ * Take the oldest buffered key, returns KEYPAD_NO_KEY if there is none
+ */
+uint8 KEYPAD_readKey(void);
+/*
+ * Description :
+ * Returns the number of keys dropped because the buffer was full
+ */
+uint16 KEYPAD_getDroppedKeys(void);
+/*
+ * Description :
+ * Power down until a key in the first two columns is pressed
  */
-uint8 KEYPAD_getPressedKey(void);
+void KEYPAD_powerDown(void);
 
 #endif /* KEYPAD_H_ */
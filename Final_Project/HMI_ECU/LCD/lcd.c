@@ -12,7 +12,37 @@
 #include "lcd.h"
 #include "../common_macros.h"
 #include <util/delay.h>
+#include <avr/pgmspace.h>
 #include "../GPIO/gpio.h"
+#include "../Trace/trace.h"
+#include "../Format/format.h"
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* HD44780 timing: enable pulse, execution time of a byte and of clear display */
+#define LCD_ENABLE_PULSE_US 1
+#define LCD_EXECUTION_US 40
+#define LCD_CLEAR_US 1600
+
+#if (LCD_Mode == 4)
+/* D4-D7 must be adjacent pins in order so a nibble is one port write */
+#if (LCD_D5_PIN != LCD_D4_PIN + 1) || (LCD_D6_PIN != LCD_D4_PIN + 2) \
+	|| (LCD_D7_PIN != LCD_D4_PIN + 3)
+#error "LCD D4-D7 must be adjacent pins of the data port"
+#endif
+#define LCD_NIBBLE_MASK (0x0F << LCD_D4_PIN)
+#if (LCD_DATA_PORT == PORTA_ID)
+#define LCD_DATA_PORT_REG PORTA
+#elif (LCD_DATA_PORT == PORTB_ID)
+#define LCD_DATA_PORT_REG PORTB
+#elif (LCD_DATA_PORT == PORTC_ID)
+#define LCD_DATA_PORT_REG PORTC
+#else
+#define LCD_DATA_PORT_REG PORTD
+#endif
+#endif
 
 /*
  * Description:
@@ -65,96 +95,113 @@ void LCD_Init() {
 }
 /*
  * Description:
- * Sending command to LCD in 4 or 8 bit mode
- * Clear RS pin
- * Set enable pin
- * send command
- * clear enable pin
+ * Latch the data lines, the LCD reads them on the falling edge of E
  */
-void LCD_sendCommand(uint8 Instruction) {
-
-	GPIO_writePin(LCD_CTRL_PORT, LCD_RS, LOGIC_LOW);
-	_delay_ms(1);
-
-#if(LCD_Mode == 8)
+static void LCD_pulseEnable(void) {
 	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_HIGH);
-	_delay_ms(1);
-
-	GPIO_writePort(LCD_DATA_PORT, Instruction);
-	_delay_ms(1);
-
+	_delay_us(LCD_ENABLE_PULSE_US); /* Tpw = 230ns */
 	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_LOW);
-	_delay_ms(1);
-#elif (LCD_Mode==4)
-	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-	GPIO_writePin(LCD_DATA_PORT, LCD_D4_PIN, GET_BIT(Instruction, 4));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D5_PIN, GET_BIT(Instruction, 5));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D6_PIN, GET_BIT(Instruction, 6));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D7_PIN, GET_BIT(Instruction, 7));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-
-	GPIO_writePin(LCD_DATA_PORT, LCD_D4_PIN, GET_BIT(Instruction, 0));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D5_PIN, GET_BIT(Instruction, 1));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D6_PIN, GET_BIT(Instruction, 2));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D7_PIN, GET_BIT(Instruction, 3));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_LOW); /* Disable LCD E=0 */
+	_delay_us(LCD_ENABLE_PULSE_US); /* Th and the rest of the enable cycle */
+}
+#if (LCD_Mode == 4)
+/*
+ * Description:
+ * Put a nibble on D4-D7 with one port write, the other pins of the port keep their value
+ */
+static void LCD_writeNibble(uint8 nibble) {
+	LCD_DATA_PORT_REG = (LCD_DATA_PORT_REG & ~LCD_NIBBLE_MASK)
+			| ((nibble << LCD_D4_PIN) & LCD_NIBBLE_MASK);
+	LCD_pulseEnable();
+}
 #endif
+/*
+ * Description:
+ * Send a byte to the LCD with RS already selected and wait until it is executed
+ * 8 bit mode writes the whole port, 4 bit mode writes the high then the low nibble
+ */
+static void LCD_write(uint8 value) {
+#if (LCD_Mode == 8)
+	GPIO_writePort(LCD_DATA_PORT, value);
+	LCD_pulseEnable();
+#elif (LCD_Mode == 4)
+	LCD_writeNibble(value >> 4);
+	LCD_writeNibble(value);
+#endif
+	_delay_us(LCD_EXECUTION_US);
+}
+/*
+ * Description:
+ * DDRAM address of a position
+ */
+static uint8 LCD_address(uint8 row, uint8 col) {
+	static const uint8 rowStart[4] = { 0x00, 0x40, 0x10, 0x50 };
+	return rowStart[row & 0x03] + col;
+}
+/*
+ * Description:
+ * Sending command to LCD in 4 or 8 bit mode
+ * Clear RS pin and send the command
+ * clear display and return home take longer than the other commands
+ */
+void LCD_sendCommand(uint8 Instruction) {
+	GPIO_writePin(LCD_CTRL_PORT, LCD_RS, LOGIC_LOW);
+	LCD_write(Instruction);
+	if (Instruction <= 0x03)
+		_delay_us(LCD_CLEAR_US);
 }
 
 /*
  * Description:
  * print char on LCD
- * 1. Set RS pin
- * 2. Set enable pin
- * 3. send data
- * 4. clear enable pin
+ * Set RS pin and send the data
  */
 void LCD_displayCharacter(uint8 data) {
-
 	GPIO_writePin(LCD_CTRL_PORT, LCD_RS, LOGIC_HIGH);
-	_delay_ms(1);
-
-#if(LCD_Mode == 8)
-	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_HIGH);
-	_delay_ms(1);
-
-	GPIO_writePort(LCD_DATA_PORT, data);
-	_delay_ms(1);
-
-	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_LOW);
-	_delay_ms(1);
-#elif (LCD_Mode==4)
-	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-	GPIO_writePin(LCD_DATA_PORT, LCD_D4_PIN, GET_BIT(data, 4));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D5_PIN, GET_BIT(data, 5));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D6_PIN, GET_BIT(data, 6));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D7_PIN, GET_BIT(data, 7));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-
-	GPIO_writePin(LCD_DATA_PORT, LCD_D4_PIN, GET_BIT(data, 0));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D5_PIN, GET_BIT(data, 1));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D6_PIN, GET_BIT(data, 2));
-	GPIO_writePin(LCD_DATA_PORT, LCD_D7_PIN, GET_BIT(data, 3));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_CTRL_PORT, LCD_E, LOGIC_LOW); /* Disable LCD E=0 */
-#endif
+	LCD_write(data);
+}
+/*
+ * Description:
+ * Write len characters of str from a position
+ * the DDRAM address and the characters are sent in one burst, RS is switched
+ * once and only the execution time of each byte is waited
+ */
+void LCD_writeAt(uint8 row, uint8 col, const uint8 *str, uint8 len) {
+	GPIO_writePin(LCD_CTRL_PORT, LCD_RS, LOGIC_LOW);
+	LCD_write(LCD_address(row, col) | 0x80);
+	GPIO_writePin(LCD_CTRL_PORT, LCD_RS, LOGIC_HIGH);
+	while (len != 0) {
+		LCD_write(*str++);
+		len--;
+	}
+}
+/*
+ * Description:
+ * Write a list of segments in one pass, a whole screen is one call
+ */
+void LCD_writeBatch(const LCD_SegmentType *segments, uint8 count) {
+	uint8 i;
+	TRACE_EVENT(TRACE_LCD_STRING_BEGIN, count);
+	for (i = 0; i < count; i++) {
+		LCD_writeAt(segments[i].row, segments[i].col, segments[i].text,
+				segments[i].length);
+	}
+	TRACE_EVENT(TRACE_LCD_STRING_END, count);
 }
 
+/*
+ * Description:
+ * Load a custom character from the flash to a CGRAM slot "0-7"
+ * the LCD is left addressing the CGRAM so set the cursor before writing text
+ */
+void LCD_defineGlyph(uint8 slot, const uint8 *bitmap) {
+	uint8 i;
+	GPIO_writePin(LCD_CTRL_PORT, LCD_RS, LOGIC_LOW);
+	LCD_write(0x40 | ((slot & 0x07) << 3));
+	GPIO_writePin(LCD_CTRL_PORT, LCD_RS, LOGIC_HIGH);
+	for (i = 0; i < 8; i++) {
+		LCD_write(pgm_read_byte(bitmap + i));
+	}
+}
 /*
  * Description:
  * Printing string on the LCD
@@ -163,9 +210,24 @@ void LCD_displayCharacter(uint8 data) {
  */
 void LCD_displayString(uint8 *data) {
 	uint8 i;
+	TRACE_EVENT(TRACE_LCD_STRING_BEGIN, 0);
 	for (i = 0; *(data + i) != '\0'; i++) {
 		LCD_displayCharacter(*(data + i));
 	}
+	TRACE_EVENT(TRACE_LCD_STRING_END, i);
+}
+/*
+ * Description:
+ * Printing a string stored in the flash "PROGMEM" on the LCD
+ * the string isn't copied to the RAM, each character is read from the flash
+ */
+void LCD_displayString_P(const char *data) {
+	uint8 i, character;
+	TRACE_EVENT(TRACE_LCD_STRING_BEGIN, 0);
+	for (i = 0; (character = pgm_read_byte(data + i)) != '\0'; i++) {
+		LCD_displayCharacter(character);
+	}
+	TRACE_EVENT(TRACE_LCD_STRING_END, i);
 }
 
 /*
@@ -173,6 +235,7 @@ void LCD_displayString(uint8 *data) {
  * Clearing LCD
  */
 void LCD_ClearDisplay() {
+	TRACE_EVENT(TRACE_LCD_CLEAR, 0);
 	LCD_sendCommand(0x01);
 }
 /*
@@ -180,133 +243,35 @@ void LCD_ClearDisplay() {
  * Set the cursor to start in a certain position
  */
 void LCD_SetCursor(uint8 row, uint8 col) {
-
-	uint8 lcd_memory_address;
-
-	/* Calculate the required address in the LCD DDRAM */
-	switch (row) {
-	case 0:
-		lcd_memory_address = col;
-		break;
-	case 1:
-		lcd_memory_address = col + 0x40;
-		break;
-	case 2:
-		lcd_memory_address = col + 0x10;
-		break;
-	case 3:
-		lcd_memory_address = col + 0x50;
-		break;
-	}
-	/* Move the LCD cursor to this specific address */
-	LCD_sendCommand(lcd_memory_address | 0x80);
+	/* Move the LCD cursor to this specific address in the LCD DDRAM */
+	LCD_sendCommand(LCD_address(row, col) | 0x80);
 }
 /*
  * Description:
  * print 4 bytes signed numbers
+ * the digits are written to a buffer then displayed in one string write
  */
 void LCD_PrintSigned32BitNum(sint32 num) {
-	/*check if the number is negative and prints - and make it positive*/
-	if (num < 0) {
-		LCD_displayCharacter('-');
-		num = -num;
-	}
-	/*
-	 * check if the number is float "has digits after the decimal point and prints the digits before the point and
-	 * the digits after the point
-	 */
-	if ((num * 100) % 100 != 0) {
-		LCD_PrintSigned32BitNum((sint32) num);
-		LCD_displayCharacter('.');
-		LCD_PrintSigned32BitNum((num * 100) % 100);
-	} else {
-		sint32 num1 = num;
-		uint16 L_u8Counter = 1;
-
-		if (num < 10)
-			LCD_displayCharacter(num + '0');
-		else {
-			/*find the value of the number "hundreds,thousands ... " */
-			while (num >= 10) {
-				num /= 10;
-				L_u8Counter *= 10;
-			}
-			while (L_u8Counter >= 1) {
-				num = num1;
-				num1 = num % L_u8Counter;
-				num /= L_u8Counter;
-				L_u8Counter /= 10;
-				LCD_PrintSigned32BitNum(num);
-			}
-
-		}
-	}
+	uint8 buffer[FORMAT_BUFFER_SIZE];
+	Format_sint32(buffer, num);
+	LCD_displayString(buffer);
 }
 /*
  * Description:
  * print 2 bytes unsigned numbers
  */
 void LCD_PrintNum16Bit(uint16 num) {
-
-	uint16 num1 = num;
-	uint16 L_u8Counter = 1;
-	if (num < 10)
-		LCD_displayCharacter(num + '0');
-	else {
-		/*find the value of the number "hundreds,thousands ... " */
-		while (num >= 10) {
-			num /= 10;
-			L_u8Counter *= 10;
-		}
-		while (L_u8Counter >= 1) {
-			num = num1;
-			num1 = num % L_u8Counter;
-			num /= L_u8Counter;
-			L_u8Counter /= 10;
-			LCD_PrintSigned32BitNum(num);
-		}
-
-	}
-
+	uint8 buffer[FORMAT_BUFFER_SIZE];
+	Format_uint16(buffer, num);
+	LCD_displayString(buffer);
 }
 /*
  * Description:
- * print 4 bytes float numbers
+ * print a fixed point number, value is the number multiplied by 10^decimals
+ * LCD_PrintFixed(2550, 2) prints "25.50" without float arithmetic
  */
-void LCD_PrintNumFloat(float32 num) {
-	/*check if the number is negative and prints - and make it positive*/
-
-	if (num < 0) {
-		LCD_displayCharacter('-');
-		num = -num;
-	}
-	/*
-	 * check if the number is float "has digits after the decimal point and prints the digits before the point and
-	 * the digits after the point
-	 */
-	if ((sint32) (num * 100) % 100 != 0) {
-		LCD_PrintNumFloat((sint32) num);
-		LCD_displayCharacter('.');
-		LCD_PrintNumFloat((sint32) (num * 100) % 100);
-	} else {
-		float32 num1 = num;
-		uint16 L_u8Counter = 1;
-		if (num < 10)
-			LCD_displayCharacter(num + '0');
-		else {
-			/*find the value of the number "hundreds,thousands ... " */
-			while (num >= 10) {
-				num /= 10;
-				L_u8Counter *= 10;
-			}
-			while (L_u8Counter >= 1) {
-				num = num1;
-				num1 = (sint32) num % L_u8Counter;
-				num /= L_u8Counter;
-				L_u8Counter /= 10;
-				LCD_PrintSigned32BitNum(num);
-			}
-
-		}
-	}
+void LCD_PrintFixed(sint32 value, uint8 decimals) {
+	uint8 buffer[FORMAT_BUFFER_SIZE];
+	Format_fixed(buffer, value, decimals);
+	LCD_displayString(buffer);
 }
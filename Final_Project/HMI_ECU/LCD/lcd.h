@@ -30,6 +30,17 @@
 #define LCD_D7_PIN PIN6_ID
 #endif
 
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+/* length characters of text written from row and col, text isn't terminated */
+typedef struct {
+	uint8 row;
+	uint8 col;
+	const uint8 *text;
+	uint8 length;
+} LCD_SegmentType;
+
 /*******************************************************************************
  *                              Functions Prototypes                           *
  *******************************************************************************/
@@ -69,6 +80,31 @@ void LCD_displayCharacter(uint8 data);
  * print each character with diplayCharacter function
  */
 void LCD_displayString(uint8 * data);
+/*
+ * Description:
+ * Printing a string stored in the flash "PROGMEM" on the LCD
+ * it takes PSTR("text") or a text of the flash table "Text_get", the text
+ * isn't copied to the RAM
+ */
+void LCD_displayString_P(const char *data);
+/*
+ * Description:
+ * Write len characters of str from a position
+ * the cursor command and the characters are sent in one burst
+ */
+void LCD_writeAt(uint8 row, uint8 col, const uint8 *str, uint8 len);
+/*
+ * Description:
+ * Write a list of segments in one pass, a whole screen is one call
+ */
+void LCD_writeBatch(const LCD_SegmentType *segments, uint8 count);
+/*
+ * Description:
+ * Load a custom character from the flash to a CGRAM slot "0-7"
+ * bitmap is 8 rows of 5 bits from the top, the characters 0-7 and 8-15 show it
+ * the LCD is left addressing the CGRAM so set the cursor before writing text
+ */
+void LCD_defineGlyph(uint8 slot, const uint8 *bitmap);
 /*
  * Description:
  * Clearing LCD
@@ -86,9 +122,10 @@ void LCD_SetCursor(uint8 row ,uint8 col);
 void LCD_PrintSigned32BitNum(sint32 num);
 /*
  * Description:
- * print 4 bytes float numbers
+ * print a fixed point number, value is the number multiplied by 10^decimals
+ * LCD_PrintFixed(2550, 2) prints "25.50" without float arithmetic
  */
-void LCD_PrintNumFloat(float32 num);
+void LCD_PrintFixed(sint32 value, uint8 decimals);
 /*
  * Description:
  * print 2 bytes unsigned numbers
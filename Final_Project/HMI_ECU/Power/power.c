@@ -0,0 +1,73 @@
+/******************************************************************************
+ *
+ * Module: Power
+ *
+ * File Name: power.c
+ *
+ * Description: Source file for the sleep modes and the sleep time statistics
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "power.h"
+#include "../Tick/tick.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+static Power_StatsType g_stats;
+static uint32 g_lastMark; /* Tick_micros when total_us was last updated */
+
+/*
+ * Description:
+ * Sleep in idle mode until the next interrupt
+ * the timers and the UART keep running so the tick, a received byte or
+ * any other interrupt wakes the CPU
+ */
+void Power_idle(void) {
+	uint32 start = Tick_micros();
+
+	/* the time awake since the last call is part of the total too */
+	g_stats.total_us += start - g_lastMark;
+	g_lastMark = start;
+
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	/*
+	 * sei just before sleep takes effect after the next instruction so an
+	 * interrupt can't slip in between and leave the CPU asleep without a wake up
+	 */
+	cli();
+	sleep_enable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+
+	g_stats.sleep_us += Tick_micros() - start;
+	g_stats.idle_sleeps++;
+}
+/*
+ * Description:
+ * Sleep in power down mode until an external interrupt or a TWI address match
+ * the caller must enable the interrupt that wakes it before calling
+ */
+void Power_down(void) {
+	g_stats.power_downs++;
+	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	cli();
+	sleep_enable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+	/* the tick stopped while powered down, don't count that gap as awake time */
+	g_lastMark = Tick_micros();
+}
+/*
+ * Description:
+ * Copy the sleep statistics
+ */
+void Power_getStats(Power_StatsType *stats) {
+	uint32 now = Tick_micros();
+	g_stats.total_us += now - g_lastMark;
+	g_lastMark = now;
+	*stats = g_stats;
+}
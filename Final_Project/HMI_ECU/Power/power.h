@@ -0,0 +1,55 @@
+/******************************************************************************
+ *
+ * Module: Power
+ *
+ * File Name: power.h
+ *
+ * Description: Header file for the sleep modes and the sleep time statistics
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef POWER_POWER_H_
+#define POWER_POWER_H_
+
+#include "../std_types.h"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+/*
+ * times are in microseconds from Tick_micros
+ * sleep_us / total_us is the idle sleep duty cycle, the time spent
+ * in power down isn't measured as the timers are stopped there
+ */
+typedef struct {
+	uint64 total_us;
+	uint64 sleep_us;
+	uint16 idle_sleeps;
+	uint16 power_downs;
+} Power_StatsType;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Sleep in idle mode until the next interrupt
+ * the timers and the UART keep running so the tick, a received byte or
+ * any other interrupt wakes the CPU
+ */
+void Power_idle(void);
+/*
+ * Description:
+ * Sleep in power down mode until an external interrupt or a TWI address match
+ * the caller must enable the interrupt that wakes it before calling
+ */
+void Power_down(void);
+/*
+ * Description:
+ * Copy the sleep statistics
+ */
+void Power_getStats(Power_StatsType *stats);
+
+#endif /* POWER_POWER_H_ */
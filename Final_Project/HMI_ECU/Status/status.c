@@ -0,0 +1,221 @@
+/******************************************************************************
+ *
+ * Module: Status
+ *
+ * File Name: status.c
+ *
+ * Description: Source file for the status events published by the control ECU
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "status.h"
+#include "../UART/uart.h"
+
+/*******************************************************************************
+ *                      		Global variables			                    *
+ *******************************************************************************/
+/* last value of every topic, a length of 0 means there is no value yet */
+static uint8 g_data[STATUS_TOPIC_COUNT][STATUS_DATA_SIZE];
+static uint8 g_length[STATUS_TOPIC_COUNT];
+static uint8 g_sequence[STATUS_TOPIC_COUNT];
+/* publisher: topics sent as they change */
+static uint8 g_subscribed = 0;
+/* subscriber: an event was missed so the values may be old */
+static uint8 g_stale = FALSE;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * send one byte of a frame, escaped if it would be taken for STATUS_START
+ */
+static void Status_sendByte(uint8 byte) {
+	if (byte == STATUS_START || byte == STATUS_ESCAPE) {
+		UART_sendData(STATUS_ESCAPE);
+		byte ^= STATUS_ESCAPE_XOR;
+	}
+	UART_sendData(byte);
+}
+/*
+ * Description:
+ * send the value of a topic: STATUS_START, type, topic, sequence number,
+ * length, data and checksum
+ */
+static void Status_send(uint8 type, uint8 topic) {
+	uint8 i;
+	uint8 sum = type + topic + g_sequence[topic] + g_length[topic];
+	UART_sendData(STATUS_START);
+	Status_sendByte(type);
+	Status_sendByte(topic);
+	Status_sendByte(g_sequence[topic]);
+	Status_sendByte(g_length[topic]);
+	for (i = 0; i < g_length[topic]; i++) {
+		Status_sendByte(g_data[topic][i]);
+		sum += g_data[topic][i];
+	}
+	Status_sendByte((uint8) -sum);
+}
+/*
+ * Description:
+ * read the rest of a frame after its STATUS_START byte and keep its value
+ * a STATUS_START in the middle means the frame was cut so the new one is read
+ * an event that doesn't follow the last sequence number of its topic marks
+ * the values stale, a snapshot sets the sequence number
+ * returns the topic and its type or STATUS_NO_TOPIC
+ */
+static uint8 Status_readFrame(uint8 *type) {
+	/* type, topic, sequence number, length, data and checksum */
+	uint8 frame[STATUS_DATA_SIZE + 5];
+	uint8 count = 0, escaped = FALSE, sum = 0, byte, topic, i;
+
+	while (count < 4 || count < frame[3] + 5) {
+		if (UART_receiveDataTimeout(&byte, STATUS_TIMEOUT_MS) != UART_OK) {
+			g_stale = TRUE;
+			return STATUS_NO_TOPIC;
+		}
+		if (byte == STATUS_START) {
+			count = 0;
+			escaped = FALSE;
+			continue;
+		}
+		if (byte == STATUS_ESCAPE) {
+			escaped = TRUE;
+			continue;
+		}
+		if (escaped) {
+			byte ^= STATUS_ESCAPE_XOR;
+			escaped = FALSE;
+		}
+		frame[count++] = byte;
+		if (count == 4 && frame[3] > STATUS_DATA_SIZE) {
+			g_stale = TRUE;
+			return STATUS_NO_TOPIC;
+		}
+	}
+	for (i = 0; i < count; i++) {
+		sum += frame[i];
+	}
+	*type = frame[0];
+	topic = frame[1];
+	if (sum != 0 || topic >= STATUS_TOPIC_COUNT
+			|| (*type != STATUS_EVENT && *type != STATUS_SNAPSHOT)) {
+		g_stale = TRUE;
+		return STATUS_NO_TOPIC;
+	}
+	if (*type == STATUS_EVENT && (uint8) (g_sequence[topic] + 1) != frame[2])
+		g_stale = TRUE;
+	g_sequence[topic] = frame[2];
+	g_length[topic] = frame[3];
+	for (i = 0; i < frame[3]; i++) {
+		g_data[topic][i] = frame[4 + i];
+	}
+	return topic;
+}
+/*
+ * Description:
+ * Publisher: set the value of a topic, if it changed its sequence number is
+ * incremented and it is sent to the subscriber
+ */
+void Status_publish(uint8 topic, const void *data, uint8 length) {
+	const uint8 *bytes = (const uint8 *) data;
+	uint8 i, changed = (length != g_length[topic]);
+
+	for (i = 0; i < length; i++) {
+		if (g_data[topic][i] != bytes[i]) {
+			g_data[topic][i] = bytes[i];
+			changed = TRUE;
+		}
+	}
+	if (!changed)
+		return;
+	g_length[topic] = length;
+	g_sequence[topic]++;
+	if (g_subscribed & STATUS_MASK(topic))
+		Status_send(STATUS_EVENT, topic);
+}
+/*
+ * Description:
+ * Publisher: answer STATUS_SUBSCRIBE or STATUS_SNAPSHOT, called after the
+ * command is received
+ */
+void Status_handleRequest(uint8 command) {
+	uint8 mask, topic;
+
+	if (UART_receiveDataTimeout(&mask, STATUS_TIMEOUT_MS) != UART_OK)
+		return;
+	if (command == STATUS_SUBSCRIBE) {
+		g_subscribed = mask;
+		return;
+	}
+	for (topic = 0; topic < STATUS_TOPIC_COUNT; topic++) {
+		if (mask & STATUS_MASK(topic))
+			Status_send(STATUS_SNAPSHOT, topic);
+	}
+}
+/*
+ * Description:
+ * Subscriber: ask the publisher to send the topics of the mask as they change
+ */
+void Status_subscribe(uint8 mask) {
+	UART_sendData(STATUS_SUBSCRIBE);
+	UART_sendData(mask);
+}
+/*
+ * Description:
+ * Subscriber: ask for the current value of the topics of the mask and wait for them
+ * the publisher samples the values when the request arrives, events received meanwhile
+ * are kept too and the bytes outside the frames are late replies that are discarded
+ * returns FALSE if any of them didn't arrive
+ */
+uint8 Status_requestSnapshot(uint8 mask) {
+	uint8 byte, type, topic;
+
+	/* this is the recovery, if it fails the values stay as they are until the next gap */
+	g_stale = FALSE;
+	UART_sendData(STATUS_SNAPSHOT);
+	UART_sendData(mask);
+	while (mask != 0) {
+		if (UART_receiveDataTimeout(&byte, STATUS_TIMEOUT_MS) != UART_OK)
+			return FALSE;
+		if (byte != STATUS_START)
+			continue;
+		topic = Status_readFrame(&type);
+		if (topic != STATUS_NO_TOPIC && type == STATUS_SNAPSHOT)
+			mask &= ~STATUS_MASK(topic);
+	}
+	return TRUE;
+}
+/*
+ * Description:
+ * Subscriber: read the rest of a frame after its STATUS_START byte and keep
+ * its value, returns the topic or STATUS_NO_TOPIC
+ */
+uint8 Status_receive(void) {
+	uint8 type;
+	return Status_readFrame(&type);
+}
+/*
+ * Description:
+ * Copy the last value of a topic to data and return its length
+ * returns 0 if no value was received or published yet
+ */
+uint8 Status_get(uint8 topic, void *data, uint8 size) {
+	uint8 *bytes = (uint8 *) data;
+	uint8 i;
+
+	if (topic >= STATUS_TOPIC_COUNT || g_length[topic] > size)
+		return 0;
+	for (i = 0; i < g_length[topic]; i++) {
+		bytes[i] = g_data[topic][i];
+	}
+	return g_length[topic];
+}
+/*
+ * Description:
+ * Subscriber: returns TRUE if an event was missed since the last snapshot
+ */
+uint8 Status_isStale(void) {
+	return g_stale;
+}
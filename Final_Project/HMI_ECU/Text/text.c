@@ -0,0 +1,53 @@
+/******************************************************************************
+ *
+ * Module: Text
+ *
+ * File Name: text.c
+ *
+ * Description: Source file for the flash table of the user interface texts
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "text.h"
+
+/*******************************************************************************
+ *                      		Global variables			                    *
+ *******************************************************************************/
+static const char g_enterPassText[] PROGMEM = "plz enter pass:";
+static const char g_reEnterText[] PROGMEM = "plz re-enter the";
+static const char g_samePassText[] PROGMEM = "same pass:";
+static const char g_savedText[] PROGMEM = "Password Saved";
+static const char g_successText[] PROGMEM = "  Successfully";
+static const char g_openOptionText[] PROGMEM = "+ : Open Door";
+static const char g_changeOptionText[] PROGMEM = "- : Change Pass";
+static const char g_wrongPassText[] PROGMEM = "   Wrong Pass";
+static const char g_truePassText[] PROGMEM = "   TRUE PASS";
+static const char g_doorIsText[] PROGMEM = "    Door is";
+static const char g_unlockingText[] PROGMEM = "   Unlocking";
+static const char g_welcomeText[] PROGMEM = "    Welcome";
+static const char g_lockingText[] PROGMEM = "   Locking";
+static const char g_errorText[] PROGMEM = "     ERROR";
+static const char g_lockoutText[] PROGMEM = "  WRONG PASS";
+static const char g_noReplyText[] PROGMEM = "No Reply";
+
+/* the table itself is in the flash too, in the same order as Text_Id */
+static const char * const g_texts[TEXT_COUNT] PROGMEM = { g_enterPassText,
+		g_reEnterText, g_samePassText, g_savedText, g_successText,
+		g_openOptionText, g_changeOptionText, g_wrongPassText, g_truePassText,
+		g_doorIsText, g_unlockingText, g_welcomeText, g_lockingText,
+		g_errorText, g_lockoutText, g_noReplyText };
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Returns the flash address of a text, read it with pgm_read_byte
+ * or display it with LCD_displayString_P
+ */
+const char *Text_get(uint8 id) {
+	if (id >= TEXT_COUNT)
+		return NULL_PTR;
+	return (const char *) pgm_read_ptr(&g_texts[id]);
+}
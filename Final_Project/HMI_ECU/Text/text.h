@@ -0,0 +1,62 @@
+/******************************************************************************
+ *
+ * Module: Text
+ *
+ * File Name: text.h
+ *
+ * Description: Header file for the flash table of the user interface texts
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef TEXT_TEXT_H_
+#define TEXT_TEXT_H_
+
+#include "../std_types.h"
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* id of no text, Text_get returns NULL_PTR for it */
+#define TEXT_NONE 0xFF
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+/*
+ * the texts are stored in the flash only, the table in text.c is in the same order
+ * the leading spaces center a text on the 16 columns of the LCD
+ */
+typedef enum {
+	TEXT_ENTER_PASS,
+	TEXT_RE_ENTER,
+	TEXT_SAME_PASS,
+	TEXT_SAVED,
+	TEXT_SUCCESS,
+	TEXT_OPEN_OPTION,
+	TEXT_CHANGE_OPTION,
+	TEXT_WRONG_PASS,
+	TEXT_TRUE_PASS,
+	TEXT_DOOR_IS,
+	TEXT_UNLOCKING,
+	TEXT_WELCOME,
+	TEXT_LOCKING,
+	TEXT_ERROR,
+	TEXT_LOCKOUT,
+	TEXT_NO_REPLY,
+	TEXT_COUNT
+} Text_Id;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Returns the flash address of a text, read it with pgm_read_byte
+ * or display it with LCD_displayString_P
+ */
+const char *Text_get(uint8 id);
+
+#endif /* TEXT_TEXT_H_ */
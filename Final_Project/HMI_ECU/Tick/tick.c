@@ -0,0 +1,94 @@
+/******************************************************************************
+ *
+ * Module: Tick
+ *
+ * File Name: tick.c
+ *
+ * Description: Source file for the system millisecond tick
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "tick.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+static volatile uint32 g_ms = 0; /* milliseconds counted since Tick_init */
+static void (*volatile g_tickCallBack)(void) = NULL_PTR; /* called every millisecond */
+
+/*
+ * Description:
+ * Start Timer2 to generate an interrupt every 1 millisecond
+ * global interrupts must be enabled by the application
+ */
+void Tick_init(void) {
+	TCNT2 = 0;
+	OCR2 = TICK_COMPARE_VALUE;
+	/* Enable Timer2 compare match interrupt */
+	TIMSK |= (1 << OCIE2);
+	/*
+	 * Configure timer control register
+	 * 1. Non PWM mode FOC2=1
+	 * 2. CTC Mode WGM21=1 & WGM20=0
+	 * 3. OC2 disconnected COM20=0 & COM21=0
+	 * 4. clock = F_CPU/64 CS22=1 CS21=0 CS20=0
+	 */
+	TCCR2 = (1 << FOC2) | (1 << WGM21) | (1 << CS22);
+}
+/*
+ * Description:
+ * Returns the number of milliseconds since Tick_init
+ */
+uint32 Tick_millis(void) {
+	uint32 ms;
+	uint8 sreg = SREG;
+	/* 32-bit read is not atomic on AVR so block the tick interrupt while reading */
+	cli();
+	ms = g_ms;
+	SREG = sreg;
+	return ms;
+}
+/*
+ * Description:
+ * Returns the number of microseconds since Tick_init with the resolution
+ * of one timer count (8us at 8MHz), it wraps after 71.6 minutes so it is
+ * for measuring short intervals with (Tick_micros() - start)
+ */
+uint32 Tick_micros(void) {
+	uint32 ms;
+	uint8 count;
+	uint8 sreg = SREG;
+	cli();
+	ms = g_ms;
+	count = TCNT2;
+	/*
+	 * the counter may have cleared after interrupts were blocked, then the
+	 * compare flag is still pending and the millisecond isn't counted yet
+	 */
+	if ((TIFR & (1 << OCF2)) && count < (TICK_COUNTS_PER_MS / 2)) {
+		ms++;
+	}
+	SREG = sreg;
+	/* constant condition, the compiler keeps only one of the conversions */
+	if ((1000UL % TICK_COUNTS_PER_MS) == 0)
+		return ms * 1000UL + (uint32) count * (1000UL / TICK_COUNTS_PER_MS);
+	return ms * 1000UL + ((uint32) count * 1000UL) / TICK_COUNTS_PER_MS;
+}
+
+/*
+ * Description:
+ * Set a function called from the tick interrupt every millisecond
+ */
+void Tick_setCallBack(void (*a_ptr)(void)) {
+	g_tickCallBack = a_ptr;
+}
+
+/*
+ * ISR for Timer 2 compare Mode
+ */
+ISR(TIMER2_COMP_vect) {
+	g_ms++;
+	if (g_tickCallBack != NULL_PTR) {
+		g_tickCallBack();
+	}
+}
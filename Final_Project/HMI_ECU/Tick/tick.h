@@ -0,0 +1,60 @@
+/******************************************************************************
+ *
+ * Module: Tick
+ *
+ * File Name: tick.h
+ *
+ * Description: Header file for the system millisecond tick
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef TICK_TICK_H_
+#define TICK_TICK_H_
+
+#include "../std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Timer2 runs in compare mode with prescaler F_CPU/64
+ * compare value = (F_CPU / 64 / 1000) - 1 to get an interrupt every 1 ms
+ */
+#define TICK_PRESCALER 64
+#define TICK_COMPARE_VALUE ((F_CPU / TICK_PRESCALER / 1000UL) - 1)
+/* timer counts in one millisecond, one count is 8us at 8MHz */
+#define TICK_COUNTS_PER_MS (TICK_COMPARE_VALUE + 1)
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Start Timer2 to generate an interrupt every 1 millisecond
+ * global interrupts must be enabled by the application
+ */
+void Tick_init(void);
+/*
+ * Description:
+ * Returns the number of milliseconds since Tick_init
+ * the counter wraps after 49.7 days so always compare differences:
+ * (Tick_millis() - start) >= period
+ */
+uint32 Tick_millis(void);
+/*
+ * Description:
+ * Returns the number of microseconds since Tick_init with the resolution
+ * of one timer count (8us at 8MHz), it wraps after 71.6 minutes so it is
+ * for measuring short intervals with (Tick_micros() - start)
+ */
+uint32 Tick_micros(void);
+/*
+ * Description:
+ * Set a function called from the tick interrupt every millisecond
+ * it runs with the interrupts disabled so it must be short
+ */
+void Tick_setCallBack(void (*a_ptr)(void));
+
+#endif /* TICK_TICK_H_ */
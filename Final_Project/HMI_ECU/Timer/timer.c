@@ -14,9 +14,13 @@
 #include "../common_macros.h"
 #include <avr/interrupt.h>
 /********************************************* Global functions **********************************************/
-static volatile void (*timer1CallBack)(void);	//Call Back Function for Timer 1
+static void (*volatile timer1CallBack)(void) = NULL_PTR;	//Call Back Function for Timer 1
+
+static volatile uint16 g_initialValue; /* TCNT1 value every period starts from in normal mode */
+
+/* clock select bits CS12:0 of TCCR1B */
+#define TIMER1_CLOCK_MASK 0x07
 
-uint16 G_initialValue; /*variable to save the initial value of TCNT1 Register to initialize it with each interrupt*/
 /*
  * Description:
  * Function to initialize Timer1:
@@ -27,35 +31,43 @@ uint16 G_initialValue; /*variable to save the initial value of TCNT1 Register to
  * 4. mode of the timer
  */
 void Timer1_init(const Timer1_ConfigType *Config_Ptr) {
+	uint8 sreg = SREG;
+	cli();
+	/* stop the clock while the timer is set up */
+	TCCR1B = 0;
 	/*
 	 * Putting the initial value in TCNT1 Register
-	 * Save the initial value in the global variable to initialize the register with each interrupt
+	 * normal mode starts every period from it, compare mode only the first one
 	 */
 	TCNT1 = Config_Ptr->initial_value;
-	G_initialValue = Config_Ptr->initial_value;
+	g_initialValue = Config_Ptr->initial_value;
 	/*
 	 * Sets FOC1A/FOC1B For Non-PWM Mode
 	 */
 	TCCR1A = (1 << FOC1A) | (1 << FOC1B);
 	/*
 	 * Enable Timer interrupt enable based on the chosen mode in register TIMSK
+	 * the other timers' bits in TIMSK are kept
 	 * select the requested mode pins "WGM10 ,WGM11, WGM12"
 	 * normal Mode 000
 	 * compare mode 100
 	 * for compare mode put the compare value in OCR1A register
 	 */
+	TIMSK &= ~((1 << TOIE1) | (1 << OCIE1A) | (1 << OCIE1B));
+	TIFR = (1 << TOV1) | (1 << OCF1A) | (1 << OCF1B);
 	switch (Config_Ptr->mode) {
 	case NORMAL_MODE:
-		TIMSK = 1 << TOIE1;
+		TIMSK |= 1 << TOIE1;
+		TCCR1B = (Config_Ptr->prescaler & TIMER1_CLOCK_MASK);
 		break;
 	case CTC_MODE:
-		TIMSK = (1 << OCIE1A);
-		TCCR1B |= (1 << WGM12);
 		OCR1A = Config_Ptr->compare_value;
+		TIMSK |= (1 << OCIE1A);
+		TCCR1B = (1 << WGM12) | (Config_Ptr->prescaler & TIMER1_CLOCK_MASK);
 		break;
 	}
 	/*
-	 * Selecting prescaler in register TCCR1B pins "CS10, CS11, CS12"
+	 * the prescaler in TCCR1B pins "CS10, CS11, CS12" starts the timer
 	 * No Clock 000
 	 * F CPU / 1 -> 001
 	 * F CPU / 8 -> 010
@@ -63,7 +75,7 @@ void Timer1_init(const Timer1_ConfigType *Config_Ptr) {
 	 * F CPU / 256 -> 100
 	 * F CPU / 1024 -> 101
 	 */
-	TCCR1B |= (Config_Ptr->prescaler & 0x07);
+	SREG = sreg;
 }
 /*
  * Description:
@@ -91,16 +103,16 @@ void Timer1_setCallBack(void (*a_ptr)(void)) {
  * ISR for Timer 1 Normal Mode
  */
 ISR(TIMER1_OVF_vect) {
-	TCNT1 = G_initialValue; /*initialize TCNT1 with the initial value*/
+	TCNT1 = g_initialValue; /*initialize TCNT1 with the initial value*/
 	if (timer1CallBack != NULL_PTR) {
 		timer1CallBack();
 	}
 }
 /*
  * ISR for Timer 1 compare Mode
+ * the hardware clears TCNT1 on the match so it isn't reloaded
  */
 ISR(TIMER1_COMPA_vect) {
-	TCNT1 = G_initialValue; /*initialize TCNT1 with the initial value*/
 	if (timer1CallBack != NULL_PTR) {
 		timer1CallBack();
 	}
@@ -32,6 +32,33 @@ typedef struct {
 	Timer1_Prescaler prescaler;
 	Timer1_Mode mode;
 } Timer1_ConfigType;
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/*
+ * Compile time Timer1 settings from a duration in milliseconds and F_CPU:
+ * TIMER1_COMPARE_FOR_MS(ms, prescaler): the CTC compare value, rounded to the
+ *     nearest count, it fails to compile with a negative array size error if
+ *     the duration doesn't fit in the 16-bit compare register
+ */
+#define TIMER1_DIVISION(prescaler) \
+	((prescaler) == F_CPU_1 ? 1UL : (prescaler) == F_CPU_8 ? 8UL : \
+	(prescaler) == F_CPU_64 ? 64UL : (prescaler) == F_CPU_256 ? 256UL : 1024UL)
+
+#define TIMER1_COUNTS(ms, division) \
+	((((unsigned long long) F_CPU * (ms) / 1000ULL) + (division) / 2) / (division))
+
+#define TIMER1_FITS(ms, division) \
+	(TIMER1_COUNTS(ms, division) >= 1 && TIMER1_COUNTS(ms, division) <= 65536ULL)
+
+/* adds 0 when cond holds, else the array size is negative and compiling stops */
+#define TIMER1_CHECK(cond) (sizeof(char[(cond) ? 1 : -1]) - 1)
+
+#define TIMER1_COMPARE_FOR_MS(ms, prescaler) \
+	((uint16) (TIMER1_COUNTS(ms, TIMER1_DIVISION(prescaler)) - 1 \
+	+ TIMER1_CHECK(TIMER1_FITS(ms, TIMER1_DIVISION(prescaler)))))
+
 /*******************************************************************************
  *                              Functions Prototypes                           *
  *******************************************************************************/
@@ -12,7 +12,35 @@
 
 #include "uart.h"
 #include "../common_macros.h"
+#include "../Tick/tick.h"
+#include "../Trace/trace.h"
+#include "../Power/power.h"
 #include <avr/io.h>
+#include <avr/interrupt.h>
+
+/* the link rate must be within the tolerance, otherwise F_CPU can't generate any listed rate */
+_Static_assert(UART_BAUD_IS_VALID(UART_LINK_BAUD),
+		"no UART baud rate is within the error tolerance at this F_CPU");
+
+/*
+ * Ring buffer filled by the RX interrupt and emptied by the receive functions
+ * the ISR only moves the head and the receive functions only move the tail
+ */
+static volatile uint8 g_rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint8 g_rxHead = 0;
+static volatile uint8 g_rxTail = 0;
+
+static volatile UART_StatsType g_stats; /* link counters reported by UART_getStats */
+
+/*
+ * Description:
+ * take the oldest received byte from the ring buffer "buffer must not be empty"
+ */
+static uint8 UART_popData(void) {
+	uint8 data = g_rxBuffer[g_rxTail];
+	g_rxTail = (g_rxTail + 1) & (UART_RX_BUFFER_SIZE - 1);
+	return data;
+}
 
 /*
  * Description:
@@ -25,8 +53,54 @@
 void UART_init(const UART_ConfigType *config_ptr) {
 	uint16 UBRRValue = 0;
 
-	/*Calculating the value of UBRR to obtain certain baud rate*/
-	UBRRValue = (uint16) (((F_CPU / (config_ptr->baud_rate * 8UL))) - 1);
+	/*
+	 * Selecting the value of UBRR to obtain certain baud rate
+	 * the values are constants so no division is done at run time
+	 */
+	switch (config_ptr->baud_rate) {
+	case RATE_2400:
+		UBRRValue = UART_UBRR_VALUE(RATE_2400);
+		break;
+	case RATE_4800:
+		UBRRValue = UART_UBRR_VALUE(RATE_4800);
+		break;
+	case RATE_9600:
+		UBRRValue = UART_UBRR_VALUE(RATE_9600);
+		break;
+	case RATE_14400:
+		UBRRValue = UART_UBRR_VALUE(RATE_14400);
+		break;
+	case RATE_19200:
+		UBRRValue = UART_UBRR_VALUE(RATE_19200);
+		break;
+	case RATE_28800:
+		UBRRValue = UART_UBRR_VALUE(RATE_28800);
+		break;
+	case RATE_38400:
+		UBRRValue = UART_UBRR_VALUE(RATE_38400);
+		break;
+	case RATE_57600:
+		UBRRValue = UART_UBRR_VALUE(RATE_57600);
+		break;
+	case RATE_76800:
+		UBRRValue = UART_UBRR_VALUE(RATE_76800);
+		break;
+	case RATE_115200:
+		UBRRValue = UART_UBRR_VALUE(RATE_115200);
+		break;
+	case RATE_230400:
+		UBRRValue = UART_UBRR_VALUE(RATE_230400);
+		break;
+	case RATE_250K:
+		UBRRValue = UART_UBRR_VALUE(RATE_250K);
+		break;
+	case RATE_500K:
+		UBRRValue = UART_UBRR_VALUE(RATE_500K);
+		break;
+	case RATE_1_M:
+		UBRRValue = UART_UBRR_VALUE(RATE_1_M);
+		break;
+	}
 	/*
 	 * Writing this bit to one to reduce the divisor of the baud rate divider
 	 * from 16 to 8 to double the transfer rate.
@@ -36,9 +110,11 @@ void UART_init(const UART_ConfigType *config_ptr) {
 	 * Writing RXEN bit and TXEN to one to enable the USART Receiver.
 	 * The Receiver and transmitter will override normal port operation
 	 * for the RxD and TxD pins when enabled.
+	 * Writing RXCIE to one to buffer every received byte in the RX interrupt
 	 * if 9 bit mode were chosen set UCZ2 to 1 "masking bit 2 in bit_data which is one when 9 bit mode is chosen"
 	 */
-	UCSRB = (1 << TXEN) | (1 << RXEN) | ((config_ptr->bit_data & 0x04) << 1);
+	UCSRB = (1 << RXCIE) | (1 << TXEN) | (1 << RXEN)
+			| ((config_ptr->bit_data & 0x04) << 1);
 	/*
 	 * Writing URSEL to one to select register UCSRC to be written
 	 * USMEL bit is zero to choose asynchronous mode
@@ -77,19 +153,17 @@ void UART_sendData(uint8 data) {
 	 * the UDR register is not empty now
 	 */
 	UDR = data;
+	g_stats.bytes_out++;
 }
 /*
  * Description:
  * receiving Data with UART
  */
 uint8 UART_receiveData(void) {
-	/* RXC flag is set when the UART receive data so wait until this flag is set to one */
-	LOOP_UNTIL_BIT_IS_SET(UCSRA, RXC);
-	/*
-	 * Read the received data from the Rx buffer (UDR)
-	 * The RXC flag will be cleared after read the data
-	 */
-	return UDR;
+	/* wait until the RX interrupt puts a byte in the ring buffer */
+	while (g_rxHead == g_rxTail)
+		;
+	return UART_popData();
 }
 
 /*
@@ -104,6 +178,8 @@ void UART_sendString(const uint8 *Str) {
 		UART_sendData(Str[i]);
 		i++;
 	}
+	g_stats.frames_out++;
+	TRACE_EVENT(TRACE_UART_FRAME_OUT, i);
 }
 
 /*
@@ -126,3 +202,113 @@ void UART_receiveString(uint8 *Str) {
 	Str[i] = '\0';
 }
 
+/*
+ * Description:
+ * receiving Data with UART waiting at most timeout_ms milliseconds
+ * a timeout of 0 only checks if a byte is already received
+ */
+UART_Status UART_receiveDataTimeout(uint8 *data, uint16 timeout_ms) {
+	uint32 start = Tick_millis();
+	uint32 waited;
+
+	while (g_rxHead == g_rxTail) {
+		waited = Tick_millis() - start;
+		if (waited >= timeout_ms) {
+			if (timeout_ms != 0) {
+				g_stats.timeouts++;
+				TRACE_EVENT(TRACE_UART_TIMEOUT, 0);
+			}
+			return UART_TIMEOUT;
+		}
+		/* the longest time a timed receive waited for its byte */
+		if (waited > g_stats.max_wait_ms)
+			g_stats.max_wait_ms = waited;
+		/* the receive interrupt or the next tick wakes the CPU */
+		Power_idle();
+	}
+	*data = UART_popData();
+	return UART_OK;
+}
+
+/*
+ * Description :
+ * Receive a string until the '#' symbol with a timeout between every two bytes.
+ * size is the size of Str including the '\0'
+ */
+UART_Status UART_receiveStringTimeout(uint8 *Str, uint8 size, uint16 timeout_ms) {
+	uint8 i = 0;
+	UART_Status status;
+
+	while (i < size) {
+		status = UART_receiveDataTimeout(&Str[i], timeout_ms);
+		if (status != UART_OK) {
+			Str[0] = '\0';
+			return status;
+		}
+		/* After receiving the whole string plus the '#', replace the '#' with '\0' */
+		if (Str[i] == '#') {
+			Str[i] = '\0';
+			g_stats.frames_in++;
+			TRACE_EVENT(TRACE_UART_FRAME_IN, i);
+			return UART_OK;
+		}
+		i++;
+	}
+	/* no '#' found in size bytes, the string doesn't fit in the buffer */
+	Str[0] = '\0';
+	g_stats.bad_frames++;
+	return UART_OVERFLOW;
+}
+
+/*
+ * Description :
+ * Discard all the received bytes that are not read yet
+ */
+void UART_flush(void) {
+	g_rxTail = g_rxHead;
+}
+
+/*
+ * Description :
+ * Count a command sent again by the protocol because its reply didn't arrive
+ */
+void UART_recordRetry(void) {
+	g_stats.retries++;
+}
+
+/*
+ * Description :
+ * Copy the link counters with the RX interrupt blocked so they are consistent
+ */
+void UART_getStats(UART_StatsType *stats) {
+	uint8 sreg = SREG;
+	cli();
+	*stats = *(UART_StatsType *) &g_stats;
+	SREG = sreg;
+}
+
+/*
+ * ISR for UART receive complete
+ * the error flags of UCSRA belong to the byte in UDR so they are read first
+ * a byte received while the ring buffer is full is dropped
+ */
+ISR(USART_RXC_vect) {
+	uint8 status = UCSRA;
+	uint8 data = UDR;
+	uint8 next = (g_rxHead + 1) & (UART_RX_BUFFER_SIZE - 1);
+
+	g_stats.bytes_in++;
+	if (BIT_IS_SET(status, FE))
+		g_stats.frame_errors++;
+	if (BIT_IS_SET(status, DOR))
+		g_stats.data_overruns++;
+	if (BIT_IS_SET(status, PE))
+		g_stats.parity_errors++;
+
+	if (next != g_rxTail) {
+		g_rxBuffer[g_rxHead] = data;
+		g_rxHead = next;
+	} else {
+		g_stats.buffer_overflows++;
+	}
+}
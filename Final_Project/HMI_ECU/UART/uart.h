@@ -13,6 +13,60 @@
 #define UART_H_
 
 #include "../std_types.h"
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+/* Size of the receive ring buffer filled by the RX interrupt, must be a power of two */
+#define UART_RX_BUFFER_SIZE 32
+
+/*
+ * Baud rate calculations in double speed mode "U2X = 1", all of them are evaluated at compile time
+ * UBRR = (Fosc/(8*baudrate))-1 rounded to the nearest value
+ * error = (actual baud rate / required baud rate) - 1 in units of 0.1%
+ */
+#define UART_DIVISOR(baud) (((F_CPU) + 4UL * (baud)) / (8UL * (baud)))
+#define UART_UBRR_VALUE(baud) ((uint16) (UART_DIVISOR(baud) - 1))
+#define UART_ACTUAL_BAUD(baud) \
+	((F_CPU) / (8UL * (UART_DIVISOR(baud) ? UART_DIVISOR(baud) : 1)))
+#define UART_BAUD_ERROR_PERMILLE(baud) \
+	((((sint32) UART_ACTUAL_BAUD(baud) - (sint32) (baud)) * 1000L) / (sint32) (baud))
+
+/*
+ * Maximum baud rate error accepted for the link "1.5% recommended for 8 bit frames with U2X"
+ * and the fastest rate of the link: the receiver holds 3 bytes so the RX interrupt
+ * may wait 3 byte times for the other interrupts "120us at 250 Kbps, 60us at 500 Kbps"
+ * the length of the other interrupts isn't measured at -O0 so the link stays at 250 Kbps
+ */
+#define UART_MAX_BAUD_ERROR_PERMILLE 15
+#define UART_LINK_MAX_BAUD 250000UL
+
+/* a baud rate is usable if UBRR fits in 12 bits and the error is within the tolerance */
+#define UART_BAUD_IS_VALID(baud) \
+	(UART_DIVISOR(baud) >= 1 && UART_DIVISOR(baud) <= 4096 \
+	&& UART_BAUD_ERROR_PERMILLE(baud) <= UART_MAX_BAUD_ERROR_PERMILLE \
+	&& UART_BAUD_ERROR_PERMILLE(baud) >= -UART_MAX_BAUD_ERROR_PERMILLE)
+#define UART_BAUD_IS_USABLE(baud) \
+	((baud) <= UART_LINK_MAX_BAUD && UART_BAUD_IS_VALID(baud))
+
+/*
+ * The baud rate of the link between the two ECUs:
+ * the fastest rate of UART_BaudRate that is usable at the configured F_CPU
+ */
+#define UART_LINK_BAUD \
+	(UART_BAUD_IS_USABLE(RATE_1_M) ? RATE_1_M : \
+	UART_BAUD_IS_USABLE(RATE_500K) ? RATE_500K : \
+	UART_BAUD_IS_USABLE(RATE_250K) ? RATE_250K : \
+	UART_BAUD_IS_USABLE(RATE_230400) ? RATE_230400 : \
+	UART_BAUD_IS_USABLE(RATE_115200) ? RATE_115200 : \
+	UART_BAUD_IS_USABLE(RATE_76800) ? RATE_76800 : \
+	UART_BAUD_IS_USABLE(RATE_57600) ? RATE_57600 : \
+	UART_BAUD_IS_USABLE(RATE_38400) ? RATE_38400 : \
+	UART_BAUD_IS_USABLE(RATE_28800) ? RATE_28800 : \
+	UART_BAUD_IS_USABLE(RATE_19200) ? RATE_19200 : \
+	UART_BAUD_IS_USABLE(RATE_14400) ? RATE_14400 : \
+	UART_BAUD_IS_USABLE(RATE_9600) ? RATE_9600 : \
+	UART_BAUD_IS_USABLE(RATE_4800) ? RATE_4800 : RATE_2400)
+
 /*******************************************************************************
  *                               Types Declaration                             *
  *******************************************************************************/
@@ -51,6 +105,29 @@ typedef struct {
 	UART_StopBit stop_bit;
 	UART_BaudRate baud_rate;
 } UART_ConfigType;
+
+typedef enum {
+	UART_OK, UART_TIMEOUT, UART_OVERFLOW
+} UART_Status;
+
+/*
+ * Link health counters, the receive counters are updated in the RX interrupt
+ * bad frames are strings dropped for not ending with '#' in the buffer size
+ */
+typedef struct {
+	uint32 bytes_in;
+	uint32 bytes_out;
+	uint16 frames_in;
+	uint16 frames_out;
+	uint16 bad_frames;
+	uint16 frame_errors;
+	uint16 data_overruns;
+	uint16 parity_errors;
+	uint16 buffer_overflows;
+	uint16 timeouts;
+	uint16 retries;
+	uint16 max_wait_ms;
+} UART_StatsType;
 /*******************************************************************************
  *                              Functions Prototypes                           *
  *******************************************************************************/
@@ -61,6 +138,7 @@ typedef struct {
  * 1-parity bit
  * 2-number of data bits
  * 3-stop bits"
+ * the UBRR value of every rate is calculated at compile time
  */
 void UART_init(const UART_ConfigType *config_ptr);
 /*
@@ -83,5 +161,35 @@ void UART_sendString(const uint8 *Str);
  * Receive the required string until the '#' symbol through UART from the other UART device.
  */
 void UART_receiveString(uint8 *Str);
+/*
+ * Description:
+ * receiving Data with UART waiting at most timeout_ms milliseconds
+ * a timeout of 0 only checks if a byte is already received
+ * returns UART_TIMEOUT if no byte arrived in time
+ */
+UART_Status UART_receiveDataTimeout(uint8 *data, uint16 timeout_ms);
+/*
+ * Description :
+ * Receive a string until the '#' symbol with a timeout between every two bytes.
+ * size is the size of Str including the '\0', a longer string returns UART_OVERFLOW
+ * and a silent sender returns UART_TIMEOUT, in both cases the string is discarded
+ */
+UART_Status UART_receiveStringTimeout(uint8 *Str, uint8 size, uint16 timeout_ms);
+/*
+ * Description :
+ * Discard all the received bytes that are not read yet
+ */
+void UART_flush(void);
+/*
+ * Description :
+ * Count a command sent again by the protocol because its reply didn't arrive
+ */
+void UART_recordRetry(void);
+/*
+ * Description :
+ * Copy the link counters, max_wait_ms is the longest time a timed receive
+ * waited for its byte
+ */
+void UART_getStats(UART_StatsType *stats);
 
 #endif /* UART_H_ */
@@ -0,0 +1,292 @@
+/******************************************************************************
+ *
+ * Module: UI
+ *
+ * File Name: ui.c
+ *
+ * Description: Source file for the table driven screen engine
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include "ui.h"
+#include "../LCD/lcd.h"
+#include "../Tick/tick.h"
+#include "../Trace/trace.h"
+#include "../Text/text.h"
+#include "../Format/format.h"
+#include "../Glyph/glyph.h"
+
+/*******************************************************************************
+ *                      		Global variables			                    *
+ *******************************************************************************/
+static const UI_ConfigType *g_config;
+static uint8 g_screen;         /* current screen id */
+static UI_ScreenType g_desc;   /* RAM copy of the current screen descriptor */
+static uint32 g_enterTime;     /* time the current screen was entered */
+static uint8 g_iconCode;       /* character of the icon of the current screen */
+static uint8 g_input[UI_INPUT_MAX];
+static uint8 g_inputLength = 0;
+/* the characters on the LCD, a redraw writes only the ones that differ */
+static uint8 g_shadow[UI_ROWS][UI_COLS];
+/* line and column UI_print writes to */
+static uint8 *g_printLine;
+static uint8 g_printCol;
+
+/*******************************************************************************
+ *                              Functions Definitions                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Find the transition of the current screen for the event and copy it to row
+ * a key without a transition of its own takes the UI_EVENT_ANY_KEY one
+ * returns FALSE if the screen has no transition for the event
+ */
+static uint8 UI_findTransition(uint8 event, uint8 isKey,
+		UI_TransitionType *row) {
+	const UI_TransitionType *entry;
+	uint8 anyKeyFound = FALSE;
+	UI_TransitionType anyKey;
+	for (entry = g_config->transitions;
+			pgm_read_byte(&entry->screen) != UI_END; entry++) {
+		if (pgm_read_byte(&entry->screen) != g_screen)
+			continue;
+		if (pgm_read_byte(&entry->event) == event) {
+			memcpy_P(row, entry, sizeof(UI_TransitionType));
+			return TRUE;
+		}
+		if (isKey && !anyKeyFound
+				&& pgm_read_byte(&entry->event) == UI_EVENT_ANY_KEY) {
+			memcpy_P(&anyKey, entry, sizeof(UI_TransitionType));
+			anyKeyFound = TRUE;
+		}
+	}
+	if (anyKeyFound)
+		*row = anyKey;
+	return anyKeyFound;
+}
+/*
+ * Description:
+ * Write the characters of the frame that differ from the LCD in one batch
+ * a run of changed characters is one segment, runs one character apart are
+ * joined as rewriting a character costs the same as a cursor command
+ */
+static void UI_flush(uint8 frame[UI_ROWS][UI_COLS]) {
+	LCD_SegmentType segments[UI_ROWS * UI_COLS / 2];
+	uint8 count = 0, row, col, start, end;
+	for (row = 0; row < UI_ROWS; row++) {
+		col = 0;
+		while (col < UI_COLS) {
+			if (frame[row][col] == g_shadow[row][col]) {
+				col++;
+				continue;
+			}
+			start = col;
+			end = col;
+			while (col < UI_COLS) {
+				if (frame[row][col] != g_shadow[row][col]) {
+					g_shadow[row][col] = frame[row][col];
+					end = col;
+				} else if (col > end + 1) {
+					break;
+				}
+				col++;
+			}
+			segments[count].row = row;
+			segments[count].col = start;
+			segments[count].text = &frame[row][start];
+			segments[count].length = end + 1 - start;
+			count++;
+		}
+	}
+	if (count != 0)
+		LCD_writeBatch(segments, count);
+}
+/*
+ * Description:
+ * Run an action of the flash action table and return its result
+ */
+static uint8 UI_runAction(uint8 action) {
+	UI_ActionType function = (UI_ActionType) pgm_read_ptr(
+			&g_config->actions[action]);
+	return function();
+}
+/*
+ * Description:
+ * Format_print sink of UI_print, the characters after the end of the line are dropped
+ */
+static void UI_put(uint8 character) {
+	if (g_printCol < UI_COLS)
+		g_printLine[g_printCol++] = character;
+}
+/*
+ * Description:
+ * Enter a screen and return the result of its entry action
+ */
+static uint8 UI_enter(uint8 screen) {
+	uint8 result = UI_EVENT_NONE;
+	uint8 oldIcon = g_desc.icon;
+	g_screen = screen;
+	memcpy_P(&g_desc, &g_config->screens[screen], sizeof(UI_ScreenType));
+	/* the new icon is taken before the old one is released so a shared icon stays loaded */
+	if (g_desc.icon != GLYPH_NONE)
+		g_iconCode = Glyph_acquire(g_desc.icon);
+	Glyph_release(oldIcon);
+	g_enterTime = Tick_millis();
+	g_inputLength = 0;
+	TRACE_EVENT(TRACE_APP_SCREEN, screen);
+	if (g_desc.entry_action != UI_NO_ACTION)
+		result = UI_runAction(g_desc.entry_action);
+	UI_refresh();
+	return result;
+}
+/*
+ * Description:
+ * Take the transitions for the event and for the results of their actions
+ */
+static void UI_dispatch(uint8 event, uint8 isKey) {
+	UI_TransitionType row;
+	uint8 result;
+	while (event != UI_EVENT_NONE && UI_findTransition(event, isKey, &row)) {
+		isKey = FALSE;
+		result = UI_EVENT_NONE;
+		if (row.action != UI_NO_ACTION)
+			result = UI_runAction(row.action);
+		event = (row.next == UI_SAME) ? result : UI_enter(row.next);
+	}
+}
+
+/*
+ * Description:
+ * Start the engine on the first screen, the LCD must be initialized and clear
+ */
+void UI_init(const UI_ConfigType *config, uint8 firstScreen) {
+	uint8 row, col;
+	g_config = config;
+	g_desc.icon = GLYPH_NONE;
+	for (row = 0; row < UI_ROWS; row++) {
+		for (col = 0; col < UI_COLS; col++) {
+			g_shadow[row][col] = ' ';
+		}
+	}
+	UI_dispatch(UI_enter(firstScreen), FALSE);
+}
+/*
+ * Description:
+ * Handle a key from the keypad, digits go to the input field of the screen
+ * a key ends a message screen and is handled by the screen after it
+ */
+void UI_handleKey(uint8 key) {
+	uint8 screen;
+	do {
+		screen = g_screen;
+		if (g_desc.field == UI_FIELD_INPUT && key <= 9) {
+			if (g_inputLength < UI_INPUT_MAX) {
+				g_input[g_inputLength++] = key + '0';
+				UI_refresh();
+				UI_dispatch(UI_EVENT_DIGIT, FALSE);
+			}
+			return;
+		}
+		if (!(g_desc.flags & UI_MESSAGE)) {
+			UI_dispatch(key, TRUE);
+			return;
+		}
+		UI_dispatch(UI_EVENT_TIMEOUT, FALSE);
+	} while (g_screen != screen);
+}
+/*
+ * Description:
+ * Handle an event that isn't a key, like a change of a status topic
+ */
+void UI_handleEvent(uint8 event) {
+	UI_dispatch(event, FALSE);
+}
+/*
+ * Description:
+ * Raise the timeout event when the time of the screen is over
+ */
+void UI_update(void) {
+	if (g_desc.timeout_ms != 0
+			&& (Tick_millis() - g_enterTime) >= g_desc.timeout_ms) {
+		/* restart the time so a screen without a timeout transition doesn't raise it again at once */
+		g_enterTime = Tick_millis();
+		UI_dispatch(UI_EVENT_TIMEOUT, FALSE);
+	}
+}
+/*
+ * Description:
+ * Build the screen in a frame and write only the characters that changed
+ */
+void UI_refresh(void) {
+	uint8 frame[UI_ROWS][UI_COLS];
+	uint8 row, col, data;
+	const char *text;
+	for (row = 0; row < UI_ROWS; row++) {
+		text = Text_get(g_desc.line[row]);
+		col = 0;
+		if (text != NULL_PTR) {
+			while (col < UI_COLS && (data = pgm_read_byte(text++)) != '\0') {
+				frame[row][col++] = data;
+			}
+		}
+		while (col < UI_COLS) {
+			frame[row][col++] = ' ';
+		}
+	}
+	if (g_desc.icon != GLYPH_NONE)
+		frame[0][UI_COLS - 1] = g_iconCode;
+	if (g_desc.field == UI_FIELD_INPUT) {
+		for (col = 0; col < g_inputLength && g_desc.field_col + col < UI_COLS;
+				col++) {
+			/*displaying * instead of the number to insure privacy */
+			frame[1][g_desc.field_col + col] = '*';
+		}
+	} else if (g_desc.field == UI_FIELD_CUSTOM && g_config->drawField != NULL_PTR) {
+		g_config->drawField(g_screen, frame);
+	}
+	UI_flush(frame);
+}
+/*
+ * Description:
+ * Write a formatted text to a line of the frame from col, the text is cut at the
+ * end of the line, returns the column after the text
+ */
+uint8 UI_print(uint8 frame[UI_ROWS][UI_COLS], uint8 row, uint8 col,
+		const char *format, ...) {
+	va_list args;
+	g_printLine = frame[row];
+	g_printCol = col;
+	va_start(args, format);
+	Format_vprint(UI_put, format, args);
+	va_end(args);
+	return g_printCol;
+}
+/*
+ * Description:
+ * Copy the typed digits as ASCII terminated by '#' and '\0' to buffer
+ * which holds UI_INPUT_MAX + 2 bytes, returns the number of digits
+ */
+uint8 UI_getInput(uint8 *buffer) {
+	uint8 i;
+	for (i = 0; i < g_inputLength; i++) {
+		buffer[i] = g_input[i];
+	}
+	buffer[i] = '#';
+	buffer[i + 1] = '\0';
+	return g_inputLength;
+}
+/*
+ * Description:
+ * Returns the current screen
+ */
+uint8 UI_getScreen(void) {
+	return g_screen;
+}
+/*
+ * Description:
+ * Returns TRUE if the current screen only waits for the user
+ */
+uint8 UI_isIdle(void) {
+	return (g_desc.flags & UI_IDLE) ? TRUE : FALSE;
+}
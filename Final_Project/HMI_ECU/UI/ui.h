@@ -0,0 +1,154 @@
+/******************************************************************************
+ *
+ * Module: UI
+ *
+ * File Name: ui.h
+ *
+ * Description: Header file for the table driven screen engine
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+
+#ifndef UI_UI_H_
+#define UI_UI_H_
+
+#include "../std_types.h"
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define UI_ROWS 2
+#define UI_COLS 16
+/* maximum number of digits typed in an input field */
+#define UI_INPUT_MAX 5
+/* key that ends an input field */
+#define UI_KEY_ENTER 13
+
+/*
+ * Events: keys are the keypad values "0-9, 13 and ASCII symbols", the
+ * engine, action and application events are above 0x80
+ */
+#define UI_EVENT_NONE 0x80     /* an action has no result */
+#define UI_EVENT_TIMEOUT 0x81  /* the screen time is over */
+#define UI_EVENT_ANY_KEY 0x82  /* matches a key that has no transition of its own */
+#define UI_EVENT_OK 0x83
+#define UI_EVENT_FAIL 0x84
+#define UI_EVENT_DIGIT 0x85    /* a digit was added to the input field */
+#define UI_EVENT_USER 0x90     /* first event free for the application actions */
+
+/* screen flags */
+#define UI_MESSAGE 0x01 /* a key ends the screen like its timeout and is handled by the next screen */
+#define UI_IDLE 0x02    /* waiting for the user only, the keypad may power down */
+
+#define UI_NO_ACTION 0xFF
+#define UI_SAME 0xFF    /* next screen of a transition that stays on the screen */
+#define UI_END 0xFF     /* screen of the last row of the transition table */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+typedef enum {
+	UI_FIELD_NONE,   /* the text only */
+	UI_FIELD_INPUT,  /* typed digits are collected and shown as '*' on the second line */
+	UI_FIELD_CUSTOM  /* drawn by the drawField function of the configuration */
+} UI_FieldType;
+
+/*
+ * A screen descriptor, stored in flash
+ * the lines are ids of the flash text table "TEXT_NONE for an empty line"
+ * lines shorter than UI_COLS are padded with spaces
+ * the icon is a one cell custom character loaded while the screen is shown
+ * an input field is cleared whenever its screen is entered
+ */
+typedef struct {
+	uint8 line[UI_ROWS];
+	UI_FieldType field;
+	uint8 field_col;     /* column of the input field */
+	uint8 icon;          /* Glyph_Id shown in the last column of the first line or GLYPH_NONE */
+	uint8 entry_action;  /* run when the screen is entered or UI_NO_ACTION */
+	uint8 flags;
+	uint16 timeout_ms;   /* UI_EVENT_TIMEOUT after this long on the screen, 0 for none */
+} UI_ScreenType;
+
+/*
+ * A row of the transition table, stored in flash
+ * the first row matching the screen and the event is taken, its action runs
+ * then the next screen is entered and the result of its entry action is
+ * handled there, if next is UI_SAME the result of the action is handled on
+ * the same screen instead so the results select the following screen
+ */
+typedef struct {
+	uint8 screen;
+	uint8 event;
+	uint8 action;
+	uint8 next;
+} UI_TransitionType;
+
+/* an action returns an event or UI_EVENT_NONE */
+typedef uint8 (*UI_ActionType)(void);
+
+typedef struct {
+	const UI_ScreenType *screens;          /* in flash, indexed by the screen id */
+	const UI_TransitionType *transitions;  /* in flash, ends with a UI_END row */
+	const UI_ActionType *actions;          /* in flash, indexed by the action id */
+	void (*drawField)(uint8 screen, uint8 frame[UI_ROWS][UI_COLS]);
+} UI_ConfigType;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+/*
+ * Description:
+ * Start the engine on the first screen, the LCD must be initialized and clear
+ */
+void UI_init(const UI_ConfigType *config, uint8 firstScreen);
+/*
+ * Description:
+ * Handle a key from the keypad, digits go to the input field of the screen
+ */
+void UI_handleKey(uint8 key);
+/*
+ * Description:
+ * Handle an event that isn't a key, like a change of a status topic
+ */
+void UI_handleEvent(uint8 event);
+/*
+ * Description:
+ * Raise the timeout event when the time of the screen is over
+ * called from the main loop
+ */
+void UI_update(void);
+/*
+ * Description:
+ * Redraw the screen, only the characters that changed are written to the LCD
+ */
+void UI_refresh(void);
+/*
+ * Description:
+ * Write a formatted text to a line of the frame from col, the text is cut at the
+ * end of the line, the format is in the flash and takes the conversions of
+ * Format_print, returns the column after the text
+ * used by the drawField function so the changes reach the LCD on the next flush
+ */
+uint8 UI_print(uint8 frame[UI_ROWS][UI_COLS], uint8 row, uint8 col,
+		const char *format, ...);
+/*
+ * Description:
+ * Copy the typed digits as ASCII terminated by '#' and '\0' to buffer
+ * which holds UI_INPUT_MAX + 2 bytes, returns the number of digits
+ */
+uint8 UI_getInput(uint8 *buffer);
+/*
+ * Description:
+ * Returns the current screen
+ */
+uint8 UI_getScreen(void);
+/*
+ * Description:
+ * Returns TRUE if the current screen only waits for the user
+ */
+uint8 UI_isIdle(void);
+
+#endif /* UI_UI_H_ */
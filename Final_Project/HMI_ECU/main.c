@@ -12,296 +12,621 @@
 #include "LCD/lcd.h"
 #include "KEYPAD/keypad.h"
 #include "UART/uart.h"
-#include "util/delay.h"
+#include "Tick/tick.h"
+#include "Diag/diag.h"
+#include "Trace/trace.h"
+#include "Power/power.h"
+#include "UI/ui.h"
+#include "Text/text.h"
+#include "Glyph/glyph.h"
+#include "Status/status.h"
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                      		definitions			                           *
+ *******************************************************************************/
+/* maximum time to wait for a reply from the control ECU before retrying */
+#define LINK_TIMEOUT_MS 500
+/* the link is quiet this long between two status frames, the bytes of a frame are back to back */
+#define LINK_QUIET_MS 2
+/* number of times a command is sent before resynchronizing the link */
+#define LINK_RETRIES 3
+/* the door moves for 15 seconds and holds for 3 seconds so wait a bit longer for each phase */
+#define DOOR_PHASE_TIMEOUT_MS 20000
+/* the buzzer is on for one minute after 3 wrong passwords */
+#define LOCKOUT_TIMEOUT_MS 65000
+/* time a message like "Wrong Pass" stays before the next screen, a key press ends it earlier */
+#define MESSAGE_TIME_MS 1000
+/* number of wrong passwords that locks the system for a minute */
+#define MAX_WRONG_PASSWORDS 3
+
+/* results of the password check besides UI_EVENT_OK and UI_EVENT_FAIL "no reply" */
+#define EVENT_WRONG_PASS (UI_EVENT_USER + 0)
+#define EVENT_LOCKOUT (UI_EVENT_USER + 1)
+/* door phases published by the control ECU, see phaseEvent */
+#define EVENT_DOOR_OPENING (UI_EVENT_USER + 2)
+#define EVENT_DOOR_OPEN (UI_EVENT_USER + 3)
+#define EVENT_DOOR_CLOSING (UI_EVENT_USER + 4)
+#define EVENT_ALARM (UI_EVENT_USER + 5)
+#define EVENT_DOOR_IDLE (UI_EVENT_USER + 6)
+/* topics the HMI ECU is sent as they change */
+#define STATUS_TOPICS (STATUS_MASK(STATUS_DOOR) | STATUS_MASK(STATUS_LOCKOUT))
+/* door phase before the first snapshot, any phase is new */
+#define PHASE_UNKNOWN 0xFF
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+/* the screens, in the same order as g_screens */
+enum {
+	SCREEN_START,
+	SCREEN_SET_PASS,
+	SCREEN_RE_ENTER_PASS,
+	SCREEN_PASS_SAVED,
+	SCREEN_MENU,
+	SCREEN_OPEN_PASS,
+	SCREEN_CHANGE_PASS,
+	SCREEN_OPEN_WRONG,
+	SCREEN_CHANGE_WRONG,
+	SCREEN_OPEN_TRUE,
+	SCREEN_CHANGE_TRUE,
+	SCREEN_UNLOCKING,
+	SCREEN_DOOR_OPEN,
+	SCREEN_LOCKING,
+	SCREEN_LOCKOUT,
+	SCREEN_HMI_STATS,
+	SCREEN_CONTROL_STATS,
+	SCREEN_NO_REPLY
+};
+/* the actions, in the same order as g_actions */
+enum {
+	ACTION_HANDSHAKE,
+	ACTION_STORE_PASSWORD,
+	ACTION_SEND_PASSWORDS,
+	ACTION_CHECK_PASSWORD,
+	ACTION_VERIFY_OPEN,
+	ACTION_OPEN_SESSION,
+	ACTION_SEND_DIGIT,
+	ACTION_LOCKOUT,
+	ACTION_HMI_STATS,
+	ACTION_CONTROL_STATS
+};
 
 /*******************************************************************************
  *                      		Global variables			                    *
  *******************************************************************************/
 
-/*Strings for holding password and re-entered password*/
-uint8 passwordArray[6], reEnteredPasswordArray[6];
+/*Strings for holding password and re-entered password terminated by '#'*/
+uint8 passwordArray[UI_INPUT_MAX + 2], reEnteredPasswordArray[UI_INPUT_MAX + 2];
+/* wrong passwords entered since the last lockout */
+uint8 g_wrongPasswords = 0;
+/* link counters shown by the diagnostic screens and the ECU they belong to */
+UART_StatsType g_stats;
+uint8 g_statsEcu;
 /*
- * variable for holding the keypad input value
- * variable for counting the index to put input values in the array
+ * last door phase received and its event waiting for the main loop
+ * a phase received while an action waits for a reply is handled after the action
  */
-uint8 input, counter = 0;
-/*Flag for controlling input in the password array or the re entered password array
- * True if the password was entered
+uint8 g_doorPhase = PHASE_UNKNOWN;
+uint8 g_doorEvent = UI_EVENT_NONE;
+
+/*******************************************************************************
+ *                      		Screens	     			                       *
+ *******************************************************************************/
+/*
+ * lines, field, field column, icon, entry action, flags and timeout of every screen
+ * the door screens and the lockout follow the door phase published by the control ECU
+ * the lockout shows the seconds left of the alarm published by the control ECU
  */
-uint8 inputFlag = FALSE, matchingPasswordsFlag = FALSE;
+static const UI_ScreenType g_screens[] PROGMEM = {
+	/* SCREEN_START */
+	{ { TEXT_NONE, TEXT_NONE }, UI_FIELD_NONE, 0, GLYPH_NONE,
+			ACTION_HANDSHAKE, 0, 0 },
+	/* SCREEN_SET_PASS */
+	{ { TEXT_ENTER_PASS, TEXT_NONE }, UI_FIELD_INPUT, 0, GLYPH_KEY,
+			UI_NO_ACTION, UI_IDLE, 0 },
+	/* SCREEN_RE_ENTER_PASS */
+	{ { TEXT_RE_ENTER, TEXT_SAME_PASS }, UI_FIELD_INPUT, 11, GLYPH_NONE,
+			UI_NO_ACTION, UI_IDLE, 0 },
+	/* SCREEN_PASS_SAVED */
+	{ { TEXT_SAVED, TEXT_SUCCESS }, UI_FIELD_NONE, 0, GLYPH_NONE,
+			UI_NO_ACTION, UI_MESSAGE, MESSAGE_TIME_MS },
+	/* SCREEN_MENU */
+	{ { TEXT_OPEN_OPTION, TEXT_CHANGE_OPTION }, UI_FIELD_NONE, 0, GLYPH_LOCKED,
+			UI_NO_ACTION, UI_IDLE, 0 },
+	/* SCREEN_OPEN_PASS */
+	{ { TEXT_ENTER_PASS, TEXT_NONE }, UI_FIELD_INPUT, 0, GLYPH_KEY,
+			ACTION_OPEN_SESSION, UI_IDLE, 0 },
+	/* SCREEN_CHANGE_PASS */
+	{ { TEXT_ENTER_PASS, TEXT_NONE }, UI_FIELD_INPUT, 0, GLYPH_KEY,
+			ACTION_OPEN_SESSION, UI_IDLE, 0 },
+	/* SCREEN_OPEN_WRONG */
+	{ { TEXT_WRONG_PASS, TEXT_NONE }, UI_FIELD_NONE, 0, GLYPH_NONE,
+			UI_NO_ACTION, UI_MESSAGE, MESSAGE_TIME_MS },
+	/* SCREEN_CHANGE_WRONG */
+	{ { TEXT_WRONG_PASS, TEXT_NONE }, UI_FIELD_NONE, 0, GLYPH_NONE,
+			UI_NO_ACTION, UI_MESSAGE, MESSAGE_TIME_MS },
+	/* SCREEN_OPEN_TRUE */
+	{ { TEXT_TRUE_PASS, TEXT_NONE }, UI_FIELD_NONE, 0, GLYPH_NONE,
+			UI_NO_ACTION, UI_MESSAGE, MESSAGE_TIME_MS },
+	/* SCREEN_CHANGE_TRUE */
+	{ { TEXT_TRUE_PASS, TEXT_NONE }, UI_FIELD_NONE, 0, GLYPH_NONE,
+			UI_NO_ACTION, UI_MESSAGE, MESSAGE_TIME_MS },
+	/* SCREEN_UNLOCKING */
+	{ { TEXT_DOOR_IS, TEXT_UNLOCKING }, UI_FIELD_NONE, 0, GLYPH_UNLOCKED,
+			UI_NO_ACTION, 0, DOOR_PHASE_TIMEOUT_MS },
+	/* SCREEN_DOOR_OPEN */
+	{ { TEXT_WELCOME, TEXT_NONE }, UI_FIELD_NONE, 0, GLYPH_UNLOCKED,
+			UI_NO_ACTION, 0, DOOR_PHASE_TIMEOUT_MS },
+	/* SCREEN_LOCKING */
+	{ { TEXT_DOOR_IS, TEXT_LOCKING }, UI_FIELD_NONE, 0, GLYPH_LOCKED,
+			UI_NO_ACTION, 0, DOOR_PHASE_TIMEOUT_MS },
+	/* SCREEN_LOCKOUT */
+	{ { TEXT_ERROR, TEXT_LOCKOUT }, UI_FIELD_CUSTOM, 0, GLYPH_BELL,
+			UI_NO_ACTION, 0, LOCKOUT_TIMEOUT_MS },
+	/* SCREEN_HMI_STATS */
+	{ { TEXT_NONE, TEXT_NONE }, UI_FIELD_CUSTOM, 0, GLYPH_NONE,
+			ACTION_HMI_STATS, UI_IDLE, 0 },
+	/* SCREEN_CONTROL_STATS */
+	{ { TEXT_NONE, TEXT_NONE }, UI_FIELD_CUSTOM, 0, GLYPH_NONE,
+			ACTION_CONTROL_STATS, UI_IDLE, 0 },
+	/* SCREEN_NO_REPLY */
+	{ { TEXT_NO_REPLY, TEXT_NONE }, UI_FIELD_NONE, 0, GLYPH_LINK_LOST,
+			UI_NO_ACTION, UI_IDLE, 0 }
+};
+
+/*
+ * screen, event, action and next screen
+ * a transition that stays on its screen selects the next screen by the result of its action
+ * if a door phase or the end of the lockout isn't published in time the start
+ * screen synchronizes again
+ */
+static const UI_TransitionType g_transitions[] PROGMEM = {
+	/*
+	 * the first time the user sets the password, 'F' means it was set before
+	 * a sequence the control ECU is running is shown instead of the menu
+	 */
+	{ SCREEN_START, UI_EVENT_OK, UI_NO_ACTION, SCREEN_MENU },
+	{ SCREEN_START, UI_EVENT_FAIL, UI_NO_ACTION, SCREEN_SET_PASS },
+	{ SCREEN_START, EVENT_DOOR_OPENING, UI_NO_ACTION, SCREEN_UNLOCKING },
+	{ SCREEN_START, EVENT_DOOR_OPEN, UI_NO_ACTION, SCREEN_DOOR_OPEN },
+	{ SCREEN_START, EVENT_DOOR_CLOSING, UI_NO_ACTION, SCREEN_LOCKING },
+	{ SCREEN_START, EVENT_ALARM, UI_NO_ACTION, SCREEN_LOCKOUT },
+	{ SCREEN_START, EVENT_DOOR_IDLE, UI_NO_ACTION, SCREEN_MENU },
+	/* the password is entered twice, if they don't match it is entered again */
+	{ SCREEN_SET_PASS, UI_KEY_ENTER, ACTION_STORE_PASSWORD, SCREEN_RE_ENTER_PASS },
+	{ SCREEN_RE_ENTER_PASS, UI_KEY_ENTER, ACTION_SEND_PASSWORDS, UI_SAME },
+	{ SCREEN_RE_ENTER_PASS, UI_EVENT_OK, UI_NO_ACTION, SCREEN_PASS_SAVED },
+	{ SCREEN_RE_ENTER_PASS, UI_EVENT_FAIL, UI_NO_ACTION, SCREEN_SET_PASS },
+	{ SCREEN_PASS_SAVED, UI_EVENT_TIMEOUT, UI_NO_ACTION, SCREEN_MENU },
+	/* menu: '+' opens the door, '-' changes the password and '=' shows the link counters */
+	{ SCREEN_MENU, '+', UI_NO_ACTION, SCREEN_OPEN_PASS },
+	{ SCREEN_MENU, '-', UI_NO_ACTION, SCREEN_CHANGE_PASS },
+	{ SCREEN_MENU, '=', UI_NO_ACTION, SCREEN_HMI_STATS },
+	/*
+	 * the digits are sent to the control ECU as they are typed and Enter confirms them,
+	 * to open the door the control ECU starts it as soon as the password is right
+	 * no reply means the password is entered again without counting it
+	 */
+	{ SCREEN_OPEN_PASS, UI_EVENT_DIGIT, ACTION_SEND_DIGIT, UI_SAME },
+	{ SCREEN_OPEN_PASS, UI_KEY_ENTER, ACTION_VERIFY_OPEN, UI_SAME },
+	{ SCREEN_OPEN_PASS, UI_EVENT_OK, UI_NO_ACTION, SCREEN_OPEN_TRUE },
+	{ SCREEN_OPEN_PASS, EVENT_WRONG_PASS, UI_NO_ACTION, SCREEN_OPEN_WRONG },
+	{ SCREEN_OPEN_PASS, EVENT_LOCKOUT, ACTION_LOCKOUT, SCREEN_LOCKOUT },
+	{ SCREEN_OPEN_PASS, UI_EVENT_FAIL, UI_NO_ACTION, SCREEN_OPEN_PASS },
+	{ SCREEN_CHANGE_PASS, UI_EVENT_DIGIT, ACTION_SEND_DIGIT, UI_SAME },
+	{ SCREEN_CHANGE_PASS, UI_KEY_ENTER, ACTION_CHECK_PASSWORD, UI_SAME },
+	{ SCREEN_CHANGE_PASS, UI_EVENT_OK, UI_NO_ACTION, SCREEN_CHANGE_TRUE },
+	{ SCREEN_CHANGE_PASS, EVENT_WRONG_PASS, UI_NO_ACTION, SCREEN_CHANGE_WRONG },
+	{ SCREEN_CHANGE_PASS, EVENT_LOCKOUT, ACTION_LOCKOUT, SCREEN_LOCKOUT },
+	{ SCREEN_CHANGE_PASS, UI_EVENT_FAIL, UI_NO_ACTION, SCREEN_CHANGE_PASS },
+	{ SCREEN_OPEN_WRONG, UI_EVENT_TIMEOUT, UI_NO_ACTION, SCREEN_OPEN_PASS },
+	{ SCREEN_CHANGE_WRONG, UI_EVENT_TIMEOUT, UI_NO_ACTION, SCREEN_CHANGE_PASS },
+	{ SCREEN_CHANGE_TRUE, UI_EVENT_TIMEOUT, UI_NO_ACTION, SCREEN_SET_PASS },
+	/* door phases, the door moves while "TRUE PASS" is shown and may be unlocked before it expires */
+	/* a phase missed on the way is skipped, the events carry the phase not the change */
+	{ SCREEN_OPEN_TRUE, EVENT_DOOR_OPEN, UI_NO_ACTION, SCREEN_DOOR_OPEN },
+	{ SCREEN_OPEN_TRUE, UI_EVENT_TIMEOUT, UI_NO_ACTION, SCREEN_UNLOCKING },
+	{ SCREEN_UNLOCKING, EVENT_DOOR_OPEN, UI_NO_ACTION, SCREEN_DOOR_OPEN },
+	{ SCREEN_UNLOCKING, EVENT_DOOR_CLOSING, UI_NO_ACTION, SCREEN_LOCKING },
+	{ SCREEN_UNLOCKING, EVENT_DOOR_IDLE, UI_NO_ACTION, SCREEN_MENU },
+	{ SCREEN_UNLOCKING, UI_EVENT_TIMEOUT, UI_NO_ACTION, SCREEN_START },
+	{ SCREEN_DOOR_OPEN, EVENT_DOOR_CLOSING, UI_NO_ACTION, SCREEN_LOCKING },
+	{ SCREEN_DOOR_OPEN, EVENT_DOOR_IDLE, UI_NO_ACTION, SCREEN_MENU },
+	{ SCREEN_DOOR_OPEN, UI_EVENT_TIMEOUT, UI_NO_ACTION, SCREEN_START },
+	{ SCREEN_LOCKING, EVENT_DOOR_IDLE, UI_NO_ACTION, SCREEN_MENU },
+	{ SCREEN_LOCKING, UI_EVENT_TIMEOUT, UI_NO_ACTION, SCREEN_START },
+	/* the end of the one minute alarm */
+	{ SCREEN_LOCKOUT, EVENT_DOOR_IDLE, UI_NO_ACTION, SCREEN_MENU },
+	{ SCREEN_LOCKOUT, UI_EVENT_TIMEOUT, UI_NO_ACTION, SCREEN_START },
+	/* diagnostics: the HMI counters then the control ECU counters */
+	{ SCREEN_HMI_STATS, UI_EVENT_ANY_KEY, UI_NO_ACTION, SCREEN_CONTROL_STATS },
+	{ SCREEN_CONTROL_STATS, UI_EVENT_FAIL, UI_NO_ACTION, SCREEN_NO_REPLY },
+	{ SCREEN_CONTROL_STATS, UI_EVENT_ANY_KEY, UI_NO_ACTION, SCREEN_MENU },
+	{ SCREEN_NO_REPLY, UI_EVENT_ANY_KEY, UI_NO_ACTION, SCREEN_MENU },
+	{ UI_END, 0, 0, 0 }
+};
 
 /*******************************************************************************
  *                              Functions Definitions                           *
  *******************************************************************************/
 /*
  * Description:
- * Function to set or reset the password
- * the user enters two passwords and controller sends them the control ECU and waits for the result
- * if they are matched the program continues
- * else the whole process is repeated again
+ * returns the event of a door phase, the steps that end a sequence are idle
+ */
+uint8 phaseEvent(uint8 phase) {
+	switch (phase) {
+	case STATUS_PHASE_OPENING:
+		return EVENT_DOOR_OPENING;
+	case STATUS_PHASE_OPEN:
+		return EVENT_DOOR_OPEN;
+	case STATUS_PHASE_CLOSING:
+		return EVENT_DOOR_CLOSING;
+	case STATUS_PHASE_ALARM:
+		return EVENT_ALARM;
+	default:
+		return EVENT_DOOR_IDLE;
+	}
+}
+/*
+ * Description:
+ * leave the event of the door phase for the main loop if the phase changed
+ */
+void checkDoorPhase(void) {
+	Status_DoorType door;
+	if (Status_get(STATUS_DOOR, &door, sizeof(door)) == sizeof(door)
+			&& door.phase != g_doorPhase) {
+		g_doorPhase = door.phase;
+		g_doorEvent = phaseEvent(door.phase);
+	}
+}
+/*
+ * Description:
+ * read a status frame after its start byte, a door phase is left for the main loop
+ * and the lockout screen shows the new seconds left
+ */
+void receiveStatus(void) {
+	switch (Status_receive()) {
+	case STATUS_DOOR:
+		checkDoorPhase();
+		break;
+	case STATUS_LOCKOUT:
+		UI_refresh();
+		break;
+	}
+}
+/*
+ * Description:
+ * read the bytes received before a command so they aren't taken as its reply
+ * a status frame is read to its end instead of being cut in the middle
+ * and the link must be quiet for quiet_ms so no frame is arriving
+ */
+void drainLink(uint16 quiet_ms) {
+	uint8 data;
+	uint32 lastByte = Tick_millis();
+	while (1) {
+		while (UART_receiveDataTimeout(&data, 0) == UART_OK) {
+			if (data == STATUS_START)
+				receiveStatus();
+			lastByte = Tick_millis();
+		}
+		if ((Tick_millis() - lastByte) >= quiet_ms)
+			return;
+		Power_idle();
+	}
+}
+/*
+ * Description:
+ * wait until the control ECU sends the expected byte
+ * status frames are kept, any other byte is discarded
+ * returns FALSE if the expected byte didn't arrive within the timeout
+ */
+uint8 waitForByte(uint8 expected, uint16 timeout_ms) {
+	uint8 data;
+	TRACE_EVENT(TRACE_APP_WAIT_BEGIN, expected);
+	while (UART_receiveDataTimeout(&data, timeout_ms) == UART_OK) {
+		if (data == expected) {
+			TRACE_EVENT(TRACE_APP_WAIT_END, expected);
+			return TRUE;
+		}
+		if (data == STATUS_START)
+			receiveStatus();
+	}
+	TRACE_EVENT(TRACE_APP_WAIT_END, 0);
+	return FALSE;
+}
+/*
+ * Description:
+ * synchronize with the control ECU and return the first time flag
+ * send 0xFF and wait for 'Y' followed by the flag, repeat until the control ECU answers
+ * so it works whichever ECU starts first or resets
+ * the flag is 'F' once a password is saved and 0xFF for an erased EEPROM, any other
+ * byte isn't a reply so it is sent again instead of asking for a new password
+ * the status topics are subscribed again as the control ECU may have reset
  */
-void SetPassword() {
-	LCD_ClearDisplay();
-	LCD_displayString("plz enter pass:");
-	LCD_SetCursor(1, 0);
-	/*Enters a while loop until the user enters two matched passwords*/
-	while (matchingPasswordsFlag != 'A') {
-		/*taking the input from the keypad*/
-		input = KEYPAD_getPressedKey();
-		switch (input) {
-		/*if the input is number*/
-		case 1:
-		case 2:
-		case 3:
-		case 4:
-		case 5:
-		case 6:
-		case 7:
-		case 8:
-		case 9:
-		case 0:
-			/*checks which password array to store in depending on the input flag*/
-			if (inputFlag == FALSE && counter < 5) {
-				/*converting the input value to ascii and storing it in the password array*/
-				passwordArray[counter++] = input + '0';
-				LCD_displayCharacter('*');
-			} else if (inputFlag == TRUE && counter < 5) {
-				/*converting the input value to ascii and storing it in the re entered password array*/
-				reEnteredPasswordArray[counter++] = input + '0';
-				LCD_displayCharacter('*');
-			}
-			break;
-			/*if the user pressed enter*/
-		case 13:
-			/*
-			 * depending on which array is filled:
-			 * if it is the first array the user is asked to re enter the same password
-			 */
-			if (inputFlag == FALSE) {
-				/*
-				 * Prepare the program to take the re entered password by reseting the counter
-				 * clearing display and print the message to re enter the same password
-				 */
-				inputFlag = TRUE;
-				/*fill the last element by '# to prepare it for sending'*/
-				passwordArray[counter] = '#';
-				counter = 0;
-				LCD_ClearDisplay();
-				LCD_displayString("plz re-enter the ");
-				LCD_SetCursor(1, 0);
-				LCD_displayString("same pass: ");
-				/*
-				 *if it is the second array the program resets the flags and
-				 *sends the passwords to the control ECU and waits for the results
-				 */
-			} else {
-				/*fill the last element by '# to prepare it for sending'*/
-				reEnteredPasswordArray[counter] = '#';
-				counter = 0;
-				inputFlag = FALSE;
-				LCD_ClearDisplay();
-				/*send 'C' to the control ECU to inform it that the passwords will be sent*/
-				UART_sendData('C');
-				/*send the first password*/
-				UART_sendString(passwordArray);
-				/*wait for the control ECU to send 'C' to send the second password*/
-				while (UART_receiveData() != 'C')
-					;
-				/*send the second password*/
-				UART_sendString(reEnteredPasswordArray);
-				/*wait for the control ECU to send 'C' to receive the result*/
-				while (UART_receiveData() != 'C')
-					;
-				matchingPasswordsFlag = UART_receiveData();
-				/*if the two passwords are not matched result = 'B' the whole process is repeated again*/
-				if (matchingPasswordsFlag == 'B') {
-					LCD_ClearDisplay();
-					LCD_displayString("plz enter pass:");
-					LCD_SetCursor(1, 0);
-				}
-			}
-			break;
-		default:
-			break;
+uint8 linkHandshake(void) {
+	uint8 flag, firstAttempt = TRUE;
+	while (1) {
+		if (!firstAttempt)
+			UART_recordRetry();
+		firstAttempt = FALSE;
+		/* start between two status frames so no part of a frame is taken for the reply */
+		drainLink(LINK_QUIET_MS);
+		UART_sendData(0xFF);
+		if (waitForByte('Y', LINK_TIMEOUT_MS)
+				&& UART_receiveDataTimeout(&flag, LINK_TIMEOUT_MS) == UART_OK
+				&& (flag == 'F' || flag == 0xFF)) {
+			Status_subscribe(STATUS_TOPICS);
+			return flag;
 		}
 	}
-	/*display a message to inform the user that the password has been saved*/
-	LCD_displayString("Password Saved");
-	LCD_SetCursor(1, 2);
-	LCD_displayString("Successfully");
-	_delay_ms(1000);
+}
+/*
+ * Description:
+ * send the password and the re entered password to the control ECU and return its result
+ * 'A' if they are matched and 'B' if they aren't
+ * the command is retried if the control ECU doesn't reply and the link is resynchronized after
+ * LINK_RETRIES failures, in this case 'B' is returned so the user enters the passwords again
+ */
+uint8 sendPasswords(void) {
+	uint8 retry, result;
+	for (retry = 0; retry < LINK_RETRIES; retry++) {
+		if (retry != 0)
+			UART_recordRetry();
+		drainLink(0);
+		/*send 'C' to the control ECU to inform it that the passwords will be sent*/
+		UART_sendData('C');
+		/*send the first password*/
+		UART_sendString(passwordArray);
+		/*wait for the control ECU to send 'C' to send the second password*/
+		if (!waitForByte('C', LINK_TIMEOUT_MS))
+			continue;
+		/*send the second password*/
+		UART_sendString(reEnteredPasswordArray);
+		/*wait for the control ECU to send 'C' to receive the result*/
+		if (waitForByte('C', LINK_TIMEOUT_MS)
+				&& UART_receiveDataTimeout(&result, LINK_TIMEOUT_MS) == UART_OK)
+			return result;
+	}
+	linkHandshake();
+	return 'B';
+}
+/*
+ * Description:
+ * send the password to the control ECU to compare it with the saved one and return its result
+ * 'A' if it is right and 'B' if it isn't
+ * the command is retried if the control ECU doesn't reply and the link is resynchronized after
+ * LINK_RETRIES failures, in this case 0 is returned so the password is entered again
+ * without counting it as a wrong password
+ */
+uint8 checkPassword(uint8 *password) {
+	uint8 retry, result;
+	for (retry = 0; retry < LINK_RETRIES; retry++) {
+		if (retry != 0)
+			UART_recordRetry();
+		drainLink(0);
+		/*send 'M' to inform control ECU that the password will be sent and will wait for the result*/
+		UART_sendData('M');
+		/*send the password*/
+		UART_sendString(password);
+		/*waits until the control ECU send 'Z' to receive the result*/
+		if (waitForByte('Z', LINK_TIMEOUT_MS)
+				&& UART_receiveDataTimeout(&result, LINK_TIMEOUT_MS) == UART_OK)
+			return result;
+	}
+	linkHandshake();
+	return 0;
+}
+/*
+ * Description:
+ * confirm the digits sent in the verification session and return the result
+ * 'A' if the password is right and 'B' if it isn't, the control ECU compared
+ * every digit when it arrived so this is one round trip
+ * command 'V' only confirms, 'O' also opens the door when the password is right
+ * if the session missed digits or there is no reply the whole password is
+ * checked with checkPassword and the door is opened with 'T'
+ */
+uint8 confirmPassword(uint8 command, uint8 *password, uint8 length) {
+	uint8 result;
+	drainLink(0);
+	UART_sendData(command);
+	UART_sendData(length);
+	if (waitForByte('Z', LINK_TIMEOUT_MS)
+			&& UART_receiveDataTimeout(&result, LINK_TIMEOUT_MS) == UART_OK
+			&& (result == 'A' || result == 'B'))
+		return result;
+	UART_recordRetry();
+	result = checkPassword(password);
+	/*sends 'T'to inform control ECU that the user wants to open the door*/
+	if (command == 'O' && result == 'A')
+		UART_sendData('T');
+	return result;
+}
+/*
+ * Description:
+ * actions of the screens, they return the event handled next
+ */
+uint8 handshakeAction(void) {
+	uint8 event;
+	/*if it is the first time for the user asks him to set the password*/
+	if (linkHandshake() != 'F')
+		return UI_EVENT_FAIL;
+	/*
+	 * read the current state so a reset or a lost phase continues with the
+	 * sequence the control ECU is running
+	 */
+	g_doorPhase = PHASE_UNKNOWN;
+	if (Status_requestSnapshot(STATUS_TOPICS))
+		checkDoorPhase();
+	event = g_doorEvent;
+	g_doorEvent = UI_EVENT_NONE;
+	return (event == UI_EVENT_NONE) ? UI_EVENT_OK : event;
+}
+uint8 storePasswordAction(void) {
+	UI_getInput(passwordArray);
+	return UI_EVENT_NONE;
+}
+uint8 sendPasswordsAction(void) {
+	UI_getInput(reEnteredPasswordArray);
+	/*if the two passwords are not matched result = 'B' the whole process is repeated again*/
+	return (sendPasswords() == 'A') ? UI_EVENT_OK : UI_EVENT_FAIL;
+}
+uint8 verifyPassword(uint8 command) {
+	uint8 inputPassword[UI_INPUT_MAX + 2];
+	uint8 length = UI_getInput(inputPassword);
+	switch (confirmPassword(command, inputPassword, length)) {
+	case 'A':
+		return UI_EVENT_OK;
+	case 'B':
+		/*if the user enters wrong password 3 times the system is locked*/
+		if (++g_wrongPasswords == MAX_WRONG_PASSWORDS) {
+			g_wrongPasswords = 0;
+			return EVENT_LOCKOUT;
+		}
+		return EVENT_WRONG_PASS;
+	default:
+		/*the control ECU didn't reply so the password is entered again*/
+		return UI_EVENT_FAIL;
+	}
+}
+uint8 checkPasswordAction(void) {
+	return verifyPassword('V');
+}
+uint8 verifyOpenAction(void) {
+	return verifyPassword('O');
+}
+uint8 openSessionAction(void) {
+	/*send 'S' so the control ECU reads the stored password while the user types*/
+	UART_sendData('S');
+	return UI_EVENT_NONE;
+}
+uint8 sendDigitAction(void) {
+	uint8 inputPassword[UI_INPUT_MAX + 2];
+	uint8 index = UI_getInput(inputPassword) - 1;
+	/*send 'K', the index of the digit and the digit*/
+	UART_sendData('K');
+	UART_sendData(index);
+	UART_sendData(inputPassword[index]);
+	return UI_EVENT_NONE;
+}
+uint8 lockoutAction(void) {
+	/*Send 'E' to control ECU to inform it that user entered a wrong password 3 times */
+	UART_sendData('E');
+	return UI_EVENT_NONE;
+}
+uint8 hmiStatsAction(void) {
+	UART_getStats(&g_stats);
+	g_statsEcu = 'H';
+	return UI_EVENT_NONE;
+}
+uint8 controlStatsAction(void) {
+	g_statsEcu = 'C';
+	drainLink(0);
+	return (Diag_request(DIAG_LINK_STATS, (uint8 *) &g_stats, sizeof(g_stats))
+			== sizeof(g_stats)) ? UI_EVENT_OK : UI_EVENT_FAIL;
+}
+/*
+ * Description:
+ * draw the link counters of the diagnostic screens
+ * first line: ECU name, bytes received and bytes sent
+ * second line: receive errors "framing, overrun, parity, bad frames and lost bytes",
+ * timeouts and the longest wait for a byte in milliseconds
+ * the lockout screen shows the seconds left of the alarm at the end of the second line
+ */
+void drawField(uint8 screen, uint8 frame[UI_ROWS][UI_COLS]) {
+	Status_LockoutType lockout;
+	if (screen == SCREEN_LOCKOUT) {
+		if (Status_get(STATUS_LOCKOUT, &lockout, sizeof(lockout)) == sizeof(lockout)
+				&& lockout.remaining_s != 0)
+			UI_print(frame, 1, 13, PSTR("%us"), lockout.remaining_s);
+		return;
+	}
+	UI_print(frame, 0, 0, PSTR("%c I%lu"), g_statsEcu, g_stats.bytes_in);
+	UI_print(frame, 0, 9, PSTR("O%lu"), g_stats.bytes_out);
+	UI_print(frame, 1, 0, PSTR("E%u T%u W%u"),
+			g_stats.frame_errors + g_stats.data_overruns + g_stats.parity_errors
+					+ g_stats.bad_frames + g_stats.buffer_overflows,
+			g_stats.timeouts, g_stats.max_wait_ms);
 }
 
+/* in the same order as the action ids, stored in flash with the screens */
+static const UI_ActionType g_actions[] PROGMEM = { handshakeAction, storePasswordAction,
+		sendPasswordsAction, checkPasswordAction, verifyOpenAction,
+		openSessionAction, sendDigitAction, lockoutAction,
+		hmiStatsAction, controlStatsAction };
+
 /*******************************************************************************
  *                      		 Main      			                           *
  *******************************************************************************/
 int main(void) {
+	UI_ConfigType uiConfig = { g_screens, g_transitions, g_actions, drawField };
+	/* time of the last key */
+	uint32 lastKey;
+	uint8 key, data;
 	/*
 	 * Modules and devices Initializations
 	 * Timer, UART and LCD
 	 * 1. Set UART frame to 8 bit data, no parity bit and single stop bit
-	 * Baud rate to 9600
+	 * Baud rate to the fastest rate within the error tolerance "250 Kbps at 8 MHz"
 	 */
-	UART_ConfigType uartConfig = { EIGHT_BITS, NO_PARITY, ONE_BIT, RATE_9600 };
+	UART_ConfigType uartConfig = { EIGHT_BITS, NO_PARITY, ONE_BIT, UART_LINK_BAUD };
 	UART_init(&uartConfig);
 	/* 2. Initializing LCD*/
 	LCD_Init();
+	/* 3. Start the millisecond tick used for the link timeouts and the screen times */
+	Tick_init();
+	/* 4. Scan the keypad from the tick so no key is lost while the link is busy */
+	KEYPAD_init();
+	/* 5. Enable global interrupt for the tick and UART receive interrupts */
+	SREG |= (1 << 7);
 	/*
-	 * variables to store data through the program:
-	 * option choice to store user's choice whether to open the door or to reset the password
-	 * first time flag to check whether the user used the program before or not
-	 * first input counter to mark the indices of the input password array
-	 * check data to store the result whether the passwords are matched are not
-	 * repeat flag to repeat the process when the user enters wrong password
+	 * 6. synchronize with the control ECU on the start screen, then the screens
+	 * follow the keys and the status published by the control ECU
 	 */
-	uint8 optionChoice, firstTimeFlag, inputCounter = 0, checkData, repeatFlag =
-			FALSE, numberOfWrongPasswords = 0, truePassFlag = FALSE;
-	/*String of the password user enters*/
-	uint8 inputPassword[7];
-	/*send 0xFF to inform control ECU that the initializations are done*/
-	UART_sendData(0xFF);
-	/*wait until control ECU sends 'Y' to receive the value of first time flag*/
-	while (UART_receiveData() != 'Y')
-		;
-	firstTimeFlag = UART_receiveData();
-	/*if it is the first time for the user asks him to set the password*/
-	if (firstTimeFlag != 'F')
-		SetPassword();
+	UI_init(&uiConfig, SCREEN_START);
+	lastKey = Tick_millis();
 	/*Human interface code */
 	while (1) {
-		/*display a message with the choices*/
-		LCD_ClearDisplay();
-		LCD_displayString("+ : Open Door");
-		LCD_SetCursor(1, 0);
-		LCD_displayString("- : Change Pass");
-		optionChoice = KEYPAD_getPressedKey();
-		/*for either choice asks the user to enter the password*/
-		LCD_ClearDisplay();
-		LCD_displayString("plz enter pass:");
-		LCD_SetCursor(1, 0);
-		if (optionChoice == '+' || optionChoice == '-') {
-			/*Enters a loop until the user enters the right password*/
-			while (1) {
-				input = KEYPAD_getPressedKey();
-				switch (input) {
-				/*if the input is number*/
-				case 1:
-				case 2:
-				case 3:
-				case 4:
-				case 5:
-				case 6:
-				case 7:
-				case 8:
-				case 9:
-				case 0:
-					/*stores the value in the password array*/
-					inputPassword[inputCounter] = input + '0';
-					inputCounter++;
-					/*displaying * instead of the number to insure privacy */
-					LCD_displayCharacter('*');
-					break;
-					/*if the users presses enter*/
-				case 13:
-					/*fill the last element with '#' to prepare the password for sending*/
-					inputPassword[inputCounter] = '#';
-					/*reset the counter*/
-					inputCounter = 0;
-					/*send 'M' to inform HMI that the password will be sent and will wait for the result*/
-					UART_sendData('M');
-					/*send the password*/
-					UART_sendString(inputPassword);
-					/*waits until the control ECU send 'Z' to receive the result*/
-					while (UART_receiveData() != 'Z')
-						;
-					checkData = UART_receiveData();
-					LCD_ClearDisplay();
-					/*if the password is right result = 'A' the LCD displays a message and the program proceeds*/
-					if (checkData == 'A') {
-						LCD_ClearDisplay();
-						LCD_SetCursor(0, 3);
-						LCD_displayString("TRUE PASS");
-						_delay_ms(1000);
-						/*set the flag to repeat to proceed the code */
-						repeatFlag = TRUE;
-						break;
-						/*
-						 * if the password is not right result = 'B' the LCD displays a message
-						 * and increases number of wrong passwords
-						 */
-					} else if (checkData == 'B') {
-						/*if the user enters wrong password 3 times*/
-						if (numberOfWrongPasswords == 2) {
-							/*reset the number of wrong passwords*/
-							numberOfWrongPasswords = 0;
-							/*corrupting option choice by 'E' Error occurred to continue the code*/
-							optionChoice = 'E';
-							/*Send 'E' to control ECU to inform it that user entered a wrong password 3 times */
-							UART_sendData('E');
-							LCD_ClearDisplay();
-							/*display error message*/
-							LCD_SetCursor(0, 5);
-							LCD_displayString("ERROR");
-							LCD_SetCursor(1, 2);
-							LCD_displayString("WRONG PASS");
-							/*wait until the control ECU informs the HMI that the minute is finished*/
-							while (UART_receiveData() != 'D')
-								;
-							LCD_ClearDisplay();
-							/*set repeat flag to exit the loop*/
-							repeatFlag = TRUE;
-							break;
-						}
-						/*if the user enters the wrong password less than 3 times displays a message and continue the code */
-						LCD_ClearDisplay();
-						LCD_SetCursor(0, 3);
-						LCD_displayString("Wrong Pass");
-						_delay_ms(1000);
-						LCD_ClearDisplay();
-						numberOfWrongPasswords++;
-						LCD_displayString("plz enter pass:");
-						LCD_SetCursor(1, 0);
-					}
-				}
-				/*break the loop if the user entered wrong password three times or the right password*/
-				if (repeatFlag) {
-					repeatFlag = FALSE;
-					break;
-				}
-			}
+		/*
+		 * the keys are buffered by the tick interrupt so the keys pressed while an
+		 * action waited for the control ECU are handled now in order
+		 */
+		key = KEYPAD_readKey();
+		if (key != KEYPAD_NO_KEY) {
+			TRACE_EVENT(TRACE_APP_KEY, key);
+			lastKey = Tick_millis();
+			UI_handleKey(key);
+			continue;
+		}
+		/* a door phase received while an action waited for a reply */
+		if (g_doorEvent != UI_EVENT_NONE) {
+			data = g_doorEvent;
+			g_doorEvent = UI_EVENT_NONE;
+			UI_handleEvent(data);
+			continue;
+		}
+		/*
+		 * answer diagnostic requests from a host tool and keep the status frames
+		 * any other byte is a late reply and only the status frames change the screens
+		 */
+		if (UART_receiveDataTimeout(&data, 0) == UART_OK) {
+			if (data == DIAG_REQUEST)
+				Diag_handleRequest();
+			else if (data == STATUS_START)
+				receiveStatus();
+			continue;
+		}
+		/* an event was missed so read the current values again */
+		if (Status_isStale() && Status_requestSnapshot(STATUS_TOPICS)) {
+			checkDoorPhase();
+			UI_refresh();
 		}
-		/*if the user choice was to open the door*/
-		if (optionChoice == '+') {
-			/*sends 'T'to inform control ECU that the user wants to open the door*/
-			UART_sendData('T');
-			/*display message*/
-			LCD_ClearDisplay();
-			LCD_SetCursor(0, 4);
-			LCD_displayString("Door is");
-			LCD_SetCursor(1, 3);
-			LCD_displayString("Unlocking");
-			/*wait until the control ECU informs that 15 seconds are finished*/
-			while (UART_receiveData() != 'U')
-				;
-			/*dispaly message*/
-			LCD_ClearDisplay();
-			LCD_SetCursor(0, 4);
-			LCD_displayString("Welcome");
-			/*wait until the control ECU informs that 3 seconds are finished*/
-			while (UART_receiveData() != 'H')
-				;
-			/*dispaly message*/
-			LCD_ClearDisplay();
-			LCD_SetCursor(0, 4);
-			LCD_displayString("Door is");
-			LCD_SetCursor(1, 3);
-			LCD_displayString("Locking");
-			/*wait until the control ECU informs that 15 seconds are finished*/
-			while (UART_receiveData() != 'L')
-				;
-			/*if the user choice was to reset the password*/
-		} else if (optionChoice == '-') {
-			SetPassword();
+		UI_update();
+		/* power down if nobody used the keypad for a while and no door phase is expected */
+		if (UI_isIdle() && (Tick_millis() - lastKey) >= KEYPAD_POWER_DOWN_MS) {
+			KEYPAD_powerDown();
+			lastKey = Tick_millis();
 		}
+		Power_idle();
 	}
 }
@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+###############################################################################
+#
+# Tool: Link diagnostics
+#
+# File Name: diag.py
+#
+# Description: Host tool that sends diagnostic requests to an ECU over its
+#              UART and decodes the replies (see Diag/diag.h)
+#
+# Author: Mahmoud Khalafallah
+#
+###############################################################################
+"""Fetch diagnostic blocks from the Control ECU or the HMI ECU.
+
+usage: diag.py PORT stats|trace|memory|power|status [--baud 250000]
+
+requires pyserial, connect the adapter to the RxD/TxD pins of one ECU
+"""
+
+import argparse
+import struct
+import sys
+
+import serial
+
+DIAG_REQUEST = b'G'
+DIAG_LINK_STATS = b'L'
+DIAG_TRACE = b'T'
+DIAG_MEMORY = b'M'
+DIAG_POWER = b'P'
+
+# same order as Trace_EventId in Trace/trace.h
+TRACE_EVENTS = [
+    'UART_TIMEOUT',
+    'UART_FRAME_IN',
+    'UART_FRAME_OUT',
+    'TWI_STOP',
+    'EEPROM_READ_BEGIN',
+    'EEPROM_READ_END',
+    'EEPROM_WRITE_BEGIN',
+    'EEPROM_WRITE_END',
+    'LCD_STRING_BEGIN',
+    'LCD_STRING_END',
+    'LCD_CLEAR',
+    'APP_COMMAND',
+    'APP_DOOR_PHASE',
+    'APP_KEY',
+    'APP_WAIT_BEGIN',
+    'APP_WAIT_END',
+    'APP_SCREEN',
+]
+
+# same order as UART_StatsType in UART/uart.h "the firmware is built with -fpack-struct"
+STATS_FORMAT = '<II10H'
+STATS_FIELDS = [
+    'bytes_in', 'bytes_out', 'frames_in', 'frames_out', 'bad_frames',
+    'frame_errors', 'data_overruns', 'parity_errors', 'buffer_overflows',
+    'timeouts', 'retries', 'max_wait_ms',
+]
+
+
+# same order as MEM_UsageType in MEM/mem.h
+MEMORY_FORMAT = '<5H'
+MEMORY_FIELDS = ['static_size', 'stack_now', 'stack_peak', 'free_now', 'free_min']
+
+# same order as Power_StatsType in Power/power.h
+POWER_FORMAT = '<QQHH'
+
+# status frames and topics in the order of Status_Topic in Status/status.h
+STATUS_START = 0x7E
+STATUS_ESCAPE = 0x7D
+STATUS_ESCAPE_XOR = 0x20
+STATUS_SNAPSHOT = b'Q'
+STATUS_TOPICS = [
+    ('door', '<Bh', ['phase', 'position']),
+    ('motor', '<BB', ['direction', 'speed']),
+    ('lockout', '<H', ['remaining_s']),
+    ('eeprom', '<B', ['errors']),
+]
+
+# ATmega32 internal SRAM size in bytes
+RAM_SIZE = 2048
+
+
+def request(port, block_id):
+    """Send a diagnostic request and return the payload of the reply."""
+    port.reset_input_buffer()
+    port.write(DIAG_REQUEST + block_id)
+    # skip anything received before the reply header
+    while True:
+        byte = port.read(1)
+        if not byte:
+            raise TimeoutError('no reply')
+        if byte == DIAG_REQUEST:
+            break
+    header = port.read(2)
+    if len(header) != 2 or header[0:1] != block_id:
+        raise ValueError('unexpected reply header')
+    payload = port.read(header[1])
+    if len(payload) != header[1]:
+        raise TimeoutError('truncated reply')
+    return payload
+
+
+def show_stats(port):
+    payload = request(port, DIAG_LINK_STATS)
+    for name, value in zip(STATS_FIELDS, struct.unpack(STATS_FORMAT, payload)):
+        print('%-18s %d' % (name, value))
+
+
+def show_memory(port):
+    payload = request(port, DIAG_MEMORY)
+    usage = dict(zip(MEMORY_FIELDS, struct.unpack(MEMORY_FORMAT, payload)))
+    for name in MEMORY_FIELDS:
+        print('%-18s %d' % (name, usage[name]))
+    print('peak RAM use       %.1f%% of %d bytes'
+          % (100.0 * (RAM_SIZE - usage['free_min']) / RAM_SIZE, RAM_SIZE))
+    # exit status 1 if the stack came close to .bss so it can be used as a check
+    return 1 if usage['free_min'] < 64 else 0
+
+
+def show_power(port):
+    payload = request(port, DIAG_POWER)
+    total, asleep, sleeps, power_downs = struct.unpack(POWER_FORMAT, payload)
+    print('%-18s %.1f s' % ('measured', total / 1e6))
+    print('%-18s %.1f s' % ('asleep (idle)', asleep / 1e6))
+    if total:
+        print('%-18s %.1f%%' % ('sleep duty cycle', 100.0 * asleep / total))
+    print('%-18s %d' % ('idle_sleeps', sleeps))
+    print('%-18s %d' % ('power_downs', power_downs))
+    return 0
+
+
+def show_trace(port):
+    payload = request(port, DIAG_TRACE)
+    previous = None
+    base = 0
+    print('%10s %8s  %-20s %s' % ('time_ms', 'delta', 'event', 'data'))
+    for time, event, data in struct.iter_unpack('<HBB', payload):
+        # the 16-bit timestamps wrap every 65.536 seconds
+        if previous is not None and time + base < previous:
+            base += 0x10000
+        time += base
+        delta = 0 if previous is None else time - previous
+        previous = time
+        name = TRACE_EVENTS[event] if event < len(TRACE_EVENTS) else 'EVENT_%d' % event
+        shown = chr(data) if 32 < data < 127 else str(data)
+        print('%10d %+8d  %-20s %s' % (time, delta, name, shown))
+
+
+def read_status_frame(port):
+    """Read a status frame after its start byte and return it without the escapes."""
+    frame = bytearray()
+    escaped = False
+    # type, topic, sequence, length, data and checksum
+    while len(frame) < 4 or len(frame) < frame[3] + 5:
+        byte = port.read(1)
+        if not byte:
+            raise TimeoutError('truncated status frame')
+        value = byte[0]
+        if value == STATUS_START:
+            # the frame was cut, a new one starts here
+            frame = bytearray()
+            escaped = False
+            continue
+        if value == STATUS_ESCAPE:
+            escaped = True
+            continue
+        if escaped:
+            value ^= STATUS_ESCAPE_XOR
+            escaped = False
+        frame.append(value)
+    if sum(frame) & 0xFF:
+        raise ValueError('status frame checksum error')
+    return frame
+
+
+def show_status(port):
+    """Read a snapshot of every status topic of the Control ECU."""
+    port.reset_input_buffer()
+    port.write(STATUS_SNAPSHOT + bytes([(1 << len(STATUS_TOPICS)) - 1]))
+    remaining = len(STATUS_TOPICS)
+    while remaining:
+        # skip replies sent before the snapshot, status events are whole frames
+        byte = port.read(1)
+        if not byte:
+            raise TimeoutError('no reply')
+        if byte[0] != STATUS_START:
+            continue
+        frame = read_status_frame(port)
+        if frame[0:1] != STATUS_SNAPSHOT:
+            continue
+        topic, sequence, length = frame[1:4]
+        if topic >= len(STATUS_TOPICS):
+            raise ValueError('unexpected snapshot topic')
+        remaining -= 1
+        payload = bytes(frame[4:4 + length])
+        name, layout, fields = STATUS_TOPICS[topic]
+        if not length:
+            print('%-8s seq %3d  not published yet' % (name, sequence))
+            continue
+        values = struct.unpack(layout, payload)
+        print('%-8s seq %3d  %s' % (name, sequence, '  '.join(
+            '%s=%d' % item for item in zip(fields, values))))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('port')
+    parser.add_argument('block', choices=['stats', 'trace', 'memory', 'power', 'status'])
+    parser.add_argument('--baud', type=int, default=250000)
+    args = parser.parse_args()
+    with serial.Serial(args.port, args.baud, timeout=0.5) as port:
+        show = {'stats': show_stats, 'trace': show_trace, 'memory': show_memory,
+                'power': show_power, 'status': show_status}
+        return show[args.block](port) or 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
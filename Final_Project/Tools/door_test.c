@@ -0,0 +1,111 @@
+/******************************************************************************
+ *
+ * Tool: Door controller test
+ *
+ * File Name: door_test.c
+ *
+ * Description: Host test that runs the door position controller against the
+ *              door model of Control_ECU/Controller and checks every move
+ *              ends at its target in time, and the position estimate used
+ *              without position feedback
+ *
+ *              gcc -std=gnu99 -Wall -o door_test door_test.c \
+ *                  ../Control_ECU/Controller/controller.c && ./door_test
+ *
+ * Author: Mahmoud Khalafallah
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include "../Control_ECU/Controller/controller.h"
+#include "../Control_ECU/Door/door.h"
+#include "../Control_ECU/Motor/motor.h"
+
+/* a move has to finish within the time the sequence gives it */
+#define MAX_PERIODS (CONTROLLER_TRAVEL_MS / DOOR_CONTROL_PERIOD_MS)
+
+static int g_failures;
+
+static void check(int condition, const char *name) {
+	printf("%s %s\n", condition ? "pass" : "FAIL", name);
+	if (!condition)
+		g_failures++;
+}
+
+/*
+ * Description:
+ * Run one move of the model from its position to target
+ * the motor output follows the command by at most DOOR_ACCELERATION per
+ * period like the ramp of the motor driver, and stops dead on arrival
+ * like the brake
+ * returns the number of periods the move took or -1 if it never arrived
+ */
+static int runMove(Controller_PlantType *plant, sint16 target) {
+	Controller_StateType state;
+	sint16 duty = 0;
+	sint16 command = Controller_start(&state, plant->position, target);
+	int period;
+
+	for (period = 1; period <= MAX_PERIODS; period++) {
+		if (command > duty + DOOR_ACCELERATION)
+			duty += DOOR_ACCELERATION;
+		else if (command < duty - DOOR_ACCELERATION)
+			duty -= DOOR_ACCELERATION;
+		else
+			duty = command;
+		Controller_simulate(plant, duty);
+		if (Controller_update(&state, plant->position)) {
+			plant->velocity = 0;
+			plant->fraction = 0;
+			return period;
+		}
+		command = state.command;
+		if (command > MOTOR_FULL_SPEED || command < -MOTOR_FULL_SPEED)
+			return -1;
+	}
+	return -1;
+}
+
+static int withinTolerance(sint16 position, sint16 target) {
+	return (position - target <= DOOR_POSITION_TOLERANCE)
+			&& (target - position <= DOOR_POSITION_TOLERANCE);
+}
+
+int main(void) {
+	Controller_PlantType plant = { DOOR_CLOSED_POSITION, 0, 0 };
+	int periods;
+
+	periods = runMove(&plant, DOOR_OPEN_POSITION);
+	printf("open: %d ms, position %d\n", periods * DOOR_CONTROL_PERIOD_MS,
+			plant.position);
+	check(periods > 0, "open arrives in time");
+	check(withinTolerance(plant.position, DOOR_OPEN_POSITION), "open position");
+
+	periods = runMove(&plant, DOOR_CLOSED_POSITION);
+	printf("close: %d ms, position %d\n", periods * DOOR_CONTROL_PERIOD_MS,
+			plant.position);
+	check(periods > 0, "close arrives in time");
+	check(withinTolerance(plant.position, DOOR_CLOSED_POSITION),
+			"close position");
+
+	periods = runMove(&plant, 100);
+	check(periods > 0 && withinTolerance(plant.position, 100), "short move");
+	periods = runMove(&plant, plant.position + DOOR_POSITION_TOLERANCE);
+	check(periods == 1, "move within the tolerance ends at once");
+
+	check(Controller_estimate(DOOR_CLOSED_POSITION, DOOR_OPEN_POSITION, 0)
+			== DOOR_CLOSED_POSITION, "estimate at start");
+	check(Controller_estimate(DOOR_CLOSED_POSITION, DOOR_OPEN_POSITION,
+			CONTROLLER_TRAVEL_MS / 2) == DOOR_OPEN_POSITION / 2,
+			"estimate half way");
+	check(Controller_estimate(DOOR_OPEN_POSITION, DOOR_CLOSED_POSITION,
+			CONTROLLER_TRAVEL_MS / 4) == DOOR_OPEN_POSITION * 3 / 4,
+			"estimate closing");
+	check(Controller_estimate(DOOR_CLOSED_POSITION, DOOR_OPEN_POSITION,
+			CONTROLLER_TRAVEL_MS + 1000) == DOOR_OPEN_POSITION,
+			"estimate stops at the target");
+	check(Controller_estimate(3000, 2000, CONTROLLER_TRAVEL_MS / 2) == 2000,
+			"estimate of a short move stops at the target");
+
+	printf("%d failed\n", g_failures);
+	return g_failures != 0;
+}